@@ -0,0 +1,219 @@
+#pragma once
+
+#include "SimpleJSON.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Minimal Benchmark Harness for Generated Clients
+ *
+ * Runs each case until --min-time has elapsed, reports ns/op and (on Linux,
+ * when perf events are permitted) last-level cache misses per op.
+ * Results are written as JSON so they can be archived per release and
+ * compared against a baseline:
+ *
+ *   bench --out result.json --baseline last_release.json --tolerance 10
+ *
+ * Exit code is 1 if any case is slower than baseline * (1 + tolerance%).
+ */
+
+class BenchHarness {
+public:
+    struct Result {
+        std::string name;
+        uint64_t ops;
+        double nsPerOp;
+        double cacheMissesPerOp;    // -1 if unavailable
+    };
+
+private:
+    std::string suite;
+    std::string outPath;
+    std::string baselinePath;
+    std::string filter;
+    double tolerance;
+    double minTimeMs;
+    std::vector<Result> results;
+    int perfFd;
+
+public:
+    BenchHarness(const std::string& suiteName, int argc, char** argv)
+        : suite(suiteName), tolerance(10.0), minTimeMs(200.0), perfFd(-1) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+            else if (arg == "--baseline" && i + 1 < argc) baselinePath = argv[++i];
+            else if (arg == "--tolerance" && i + 1 < argc) tolerance = std::atof(argv[++i]);
+            else if (arg == "--min-time" && i + 1 < argc) minTimeMs = std::atof(argv[++i]);
+            else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        }
+        openPerfCounter();
+    }
+
+    ~BenchHarness() {
+#if defined(__linux__)
+        if (perfFd >= 0) close(perfFd);
+#endif
+    }
+
+    /**
+     * Keep a value alive so the measured code is not optimized away
+     */
+    template<typename T>
+    static void Consume(const T& value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile char sink;
+        sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+    }
+
+    /**
+     * Measure a case
+     * @param name Case name (stable across releases)
+     * @param opsPerCall Operations performed by one call of fn
+     * @param fn Callable, receives the iteration index
+     */
+    template<typename Fn>
+    void Run(const std::string& name, uint64_t opsPerCall, Fn&& fn) {
+        if (opsPerCall == 0) return;
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+        typedef std::chrono::steady_clock clock;
+
+        // Warm up and calibrate the iteration count
+        uint64_t iterations = 1;
+        while (true) {
+            auto start = clock::now();
+            for (uint64_t i = 0; i < iterations; i++) fn(i);
+            double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            if (ms >= minTimeMs / 10 || iterations >= (1ull << 40)) break;
+            iterations *= (ms < 0.01) ? 100 : 2;
+        }
+        iterations *= 10;
+
+        perfStart();
+        auto start = clock::now();
+        for (uint64_t i = 0; i < iterations; i++) fn(i);
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        int64_t misses = perfStop();
+
+        Result r;
+        r.name = name;
+        r.ops = iterations * opsPerCall;
+        r.nsPerOp = ns / static_cast<double>(r.ops);
+        r.cacheMissesPerOp = misses < 0 ? -1.0 : static_cast<double>(misses) / static_cast<double>(r.ops);
+        results.push_back(r);
+
+        std::fprintf(stderr, "%-24s %12.3f ns/op  %14llu ops", name.c_str(), r.nsPerOp,
+                     static_cast<unsigned long long>(r.ops));
+        if (r.cacheMissesPerOp >= 0) std::fprintf(stderr, "  %.4f misses/op", r.cacheMissesPerOp);
+        std::fprintf(stderr, "\n");
+    }
+
+    /**
+     * Write results and compare with the baseline
+     * @return Process exit code (1 on regression)
+     */
+    int Finish() {
+        std::string json = toJSON();
+        if (outPath.empty()) {
+            std::cout << json;
+        } else {
+            std::ofstream out(outPath);
+            out << json;
+        }
+
+        if (baselinePath.empty()) return 0;
+        return compareBaseline() ? 0 : 1;
+    }
+
+private:
+    std::string toJSON() const {
+        std::ostringstream out;
+        out << "{\n  \"suite\": \"" << suite << "\",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"cache_misses_per_op\": " << r.cacheMissesPerOp << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return out.str();
+    }
+
+    bool compareBaseline() const {
+        std::ifstream file(baselinePath);
+        if (!file) {
+            std::cerr << "Cannot open baseline: " << baselinePath << std::endl;
+            return false;
+        }
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        SimpleJSON root = SimpleJSON::parse(text);
+
+        bool ok = true;
+        for (const auto& base : root.getArray("results")) {
+            std::string name = base.getString("name");
+            double baseNs = base.getDouble("ns_per_op");
+            for (const auto& r : results) {
+                if (r.name != name || baseNs <= 0) continue;
+                double change = (r.nsPerOp / baseNs - 1.0) * 100.0;
+                bool regressed = change > tolerance;
+                std::fprintf(stderr, "%-24s %+7.1f%% vs baseline%s\n", name.c_str(), change,
+                             regressed ? "  REGRESSION" : "");
+                ok = ok && !regressed;
+            }
+        }
+        return ok;
+    }
+
+    void openPerfCounter() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        perfFd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    void perfStart() {
+#if defined(__linux__)
+        if (perfFd < 0) return;
+        ioctl(perfFd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perfFd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    int64_t perfStop() {
+#if defined(__linux__)
+        if (perfFd < 0) return -1;
+        ioctl(perfFd, PERF_EVENT_IOC_DISABLE, 0);
+        int64_t count = 0;
+        if (read(perfFd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return count;
+#else
+        return -1;
+#endif
+    }
+};
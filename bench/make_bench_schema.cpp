@@ -0,0 +1,39 @@
+// Writes a synthetic schema with N variables for the benchmark suite
+// Usage: make_bench_schema <count> <output.json>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: make_bench_schema <count> <output.json>" << std::endl;
+        return 1;
+    }
+
+    long count = std::atol(argv[1]);
+    std::ofstream out(argv[2]);
+    if (count <= 0 || !out) {
+        std::cerr << "Invalid arguments" << std::endl;
+        return 1;
+    }
+
+    // Mix of types as found in real cells: mostly LREAL joints, some status
+    // words and flags, the occasional string
+    static const char* types[] = {"LREAL", "LREAL", "DINT", "BOOL", "LREAL", "INT", "REAL", "LREAL"};
+
+    out << "{\n  \"name\": \"Bench" << count << "\",\n  \"variables\": [\n";
+    for (long i = 0; i < count; i++) {
+        const char* direction = (i % 2 == 0) ? "toCPP" : "fromCPP";
+        out << "    {\"name\": \"v" << i << "\", ";
+        if (i % 64 == 63) {
+            out << "\"type\": \"STRING\", \"size\": 16, ";
+        } else {
+            out << "\"type\": \"" << types[i % 8] << "\", ";
+        }
+        out << "\"direction\": \"" << direction << "\"}" << (i + 1 < count ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return 0;
+}
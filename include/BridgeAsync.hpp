@@ -0,0 +1,268 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+  #error "BridgeAsync.hpp needs C++20 coroutines (-std=c++20)"
+#endif
+
+#include "GenericSharedMemory.hpp"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Async Bridge API (C++20)
+ *
+ * One reactor polls a connected client and resumes coroutines waiting on it,
+ * so any number of monitors, recorders and test sequences share a single
+ * poller instead of each spinning a thread on the mapping:
+ *
+ *   BridgeAsync::Task monitor(BridgeAsync::Reactor<ST_UR10eControl>& r) {
+ *       while (true) {
+ *           LREAL q = co_await r.Changed(&ST_ToCPP::elbow_joint);
+ *           ...
+ *       }
+ *   }
+ *
+ *   BridgeAsync::Reactor<ST_UR10eControl> reactor(client);
+ *   monitor(reactor);
+ *   reactor.Start();
+ *
+ * Tasks resume on the reactor thread. While it runs, other threads must not
+ * use the client; a task may call client.Sync() after NextPLCCycle() if the
+ * process is the C++ side of the bridge. The reactor itself only reads.
+ */
+
+namespace BridgeAsync {
+
+/**
+ * Detached coroutine, starts eagerly and frees itself when it returns
+ */
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return Task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template<typename TStruct>
+class Reactor {
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef decltype(TStruct::ToCPP) ToCPPBlock;
+    typedef decltype(TStruct::FromCPP) FromCPPBlock;
+
+    /**
+     * @param pollInterval Sleep between polls; PLC cycles and changes are seen within it
+     */
+    explicit Reactor(TypedSharedMemory<TStruct>& client,
+                     std::chrono::microseconds pollInterval = std::chrono::microseconds(250))
+        : client(client), pollInterval(pollInterval), lastChange(clock::now()) {}
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    ~Reactor() {
+        Stop();
+        // Frames of tasks still suspended here are destroyed with their locals
+        std::vector<Waiter*> left;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            left.swap(pending);
+        }
+        left.insert(left.end(), active.begin(), active.end());
+        active.clear();
+        for (Waiter* w : left) w->handle.destroy();
+    }
+
+    void Start() {
+        if (thread.joinable()) return;
+        running = true;
+        thread = std::thread([this]() {
+            while (running) {
+                Poll();
+                std::this_thread::sleep_for(this->pollInterval);
+            }
+        });
+    }
+
+    void Stop() {
+        running = false;
+        if (thread.joinable()) thread.join();
+    }
+
+    /**
+     * Drive the reactor on the calling thread instead of Start()
+     */
+    void RunFor(clock::duration duration) {
+        auto end = clock::now() + duration;
+        while (clock::now() < end) {
+            Poll();
+            std::this_thread::sleep_for(pollInterval);
+        }
+    }
+
+    /**
+     * One poll: notice PLC cycles, resume every waiter that became ready
+     */
+    void Poll() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active.insert(active.end(), pending.begin(), pending.end());
+            pending.clear();
+        }
+
+        auto now = clock::now();
+        const TStruct* data = client.GetData();
+        if (data) {
+            DINT life = data->LifePLC;
+            if (life != lastLife) {
+                lastLife = life;
+                lastChange = now;
+            }
+        }
+
+        // Ready waiters leave the list before they resume, their frame may end
+        ready.clear();
+        size_t keep = 0;
+        for (Waiter* w : active) {
+            if (w->Ready(data, now)) ready.push_back(w);
+            else active[keep++] = w;
+        }
+        active.resize(keep);
+        for (Waiter* w : ready) w->handle.resume();
+    }
+
+    size_t Waiting() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return active.size() + pending.size();
+    }
+
+    /**
+     * co_await: the next LifePLC change, yields the new LifePLC
+     */
+    auto NextPLCCycle() { return CycleAwaiter(*this); }
+
+    /**
+     * co_await: the next change of a ToCPP or FromCPP field, yields its new value
+     */
+    template<typename Block, typename F>
+    auto Changed(F Block::* field) {
+        static_assert(std::is_same<Block, ToCPPBlock>::value || std::is_same<Block, FromCPPBlock>::value,
+                      "Changed() takes a field of ST_ToCPP or ST_FromCPP");
+        static_assert(std::is_trivially_copyable<F>::value, "Changed() compares fields bytewise");
+        return ChangedAwaiter<Block, F>(*this, field);
+    }
+
+    /**
+     * co_await: LifePLC has not changed for 'timeout' (immediately if it already has not)
+     */
+    auto Stale(clock::duration timeout) { return StaleAwaiter(*this, timeout); }
+
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        virtual bool Ready(const TStruct* data, clock::time_point now) = 0;
+    protected:
+        ~Waiter() = default;
+    };
+
+    // Awaiters live in the suspended coroutine frame, so waiting allocates nothing
+    struct CycleAwaiter : Waiter {
+        Reactor& reactor;
+        DINT seen = 0;
+        explicit CycleAwaiter(Reactor& reactor) : reactor(reactor) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            const TStruct* data = reactor.client.GetData();
+            seen = data ? data->LifePLC : 0;
+            this->handle = h;
+            reactor.add(this);
+        }
+        DINT await_resume() const noexcept { return seen; }
+
+        bool Ready(const TStruct* data, clock::time_point) override {
+            if (!data || data->LifePLC == seen) return false;
+            seen = data->LifePLC;
+            return true;
+        }
+    };
+
+    template<typename Block, typename F>
+    struct ChangedAwaiter : Waiter {
+        Reactor& reactor;
+        F Block::* field;
+        F value;
+        ChangedAwaiter(Reactor& reactor, F Block::* field) : reactor(reactor), field(field) {}
+
+        static const Block* block(const TStruct* data) {
+            if constexpr (std::is_same<Block, ToCPPBlock>::value) return &data->ToCPP;
+            else return &data->FromCPP;
+        }
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            const TStruct* data = reactor.client.GetData();
+            if (data) std::memcpy(&value, &(block(data)->*field), sizeof(F));
+            else std::memset(&value, 0, sizeof(F));
+            this->handle = h;
+            reactor.add(this);
+        }
+        F await_resume() const noexcept { return value; }
+
+        bool Ready(const TStruct* data, clock::time_point) override {
+            if (!data) return false;
+            const F& current = block(data)->*field;
+            if (std::memcmp(&current, &value, sizeof(F)) == 0) return false;
+            std::memcpy(&value, &current, sizeof(F));
+            return true;
+        }
+    };
+
+    struct StaleAwaiter : Waiter {
+        Reactor& reactor;
+        clock::duration timeout;
+        StaleAwaiter(Reactor& reactor, clock::duration timeout) : reactor(reactor), timeout(timeout) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            this->handle = h;
+            reactor.add(this);
+        }
+        void await_resume() const noexcept {}
+
+        bool Ready(const TStruct*, clock::time_point now) override {
+            return now - reactor.lastChange >= timeout;
+        }
+    };
+
+    void add(Waiter* w) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(w);
+    }
+
+    TypedSharedMemory<TStruct>& client;
+    std::chrono::microseconds pollInterval;
+
+    mutable std::mutex mutex;
+    std::vector<Waiter*> pending;   // Registered since the last poll (any thread)
+    std::vector<Waiter*> active;    // Reactor thread only
+    std::vector<Waiter*> ready;
+
+    DINT lastLife = 0;
+    clock::time_point lastChange;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+};
+
+} // namespace BridgeAsync
@@ -0,0 +1,114 @@
+#ifndef BRIDGE_CAPI_H
+#define BRIDGE_CAPI_H
+
+/*
+ * C ABI for Generated Bridge Clients
+ *
+ * Every schema produces <name>_bridge_capi.cpp implementing this header;
+ * built as lib<name>bridge.so (or .dll) it lets non-C++ tooling attach to
+ * the same segment as the typed client:
+ *
+ *   g++ -std=c++17 -O2 -shared -fPIC -fvisibility=hidden -DBRIDGE_CAPI_BUILD <name>_bridge_capi.cpp -o lib<name>bridge.so
+ *
+ * The function set is identical for every schema; the field table describes
+ * the layout so tools can map fields as zero-copy views (e.g. through the
+ * buffer protocol) instead of copying them through per-field calls.
+ *
+ * Segments start with a 16 byte header {Magic, LayoutHash, Generation, Size};
+ * field offsets include it. bridge_connect fails for a segment of another
+ * layout, and bridge_sync remaps when the PLC recreates the segment.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+  #ifdef BRIDGE_CAPI_BUILD
+    #define BRIDGE_API __declspec(dllexport)
+  #else
+    #define BRIDGE_API __declspec(dllimport)
+  #endif
+#else
+  #define BRIDGE_API __attribute__((visibility("default")))
+#endif
+
+#define BRIDGE_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct bridge_client bridge_client;
+
+enum { BRIDGE_TO_CPP = 0, BRIDGE_FROM_CPP = 1 };
+
+/* One variable of the segment */
+typedef struct bridge_field {
+    const char* name;
+    const char* type;       /* IEC type stored in the segment ("LREAL", "INT", "STRING") */
+    const char* format;     /* Buffer protocol format of one element ("d", "h", "17s") */
+    uint32_t direction;     /* BRIDGE_TO_CPP or BRIDGE_FROM_CPP */
+    uint32_t offset;        /* Bytes from the start of the segment */
+    uint32_t size;          /* Bytes */
+    double scale;           /* Engineering value = raw * scale + bias (1 and 0 unless encoded) */
+    double bias;
+} bridge_field;
+
+/* Schema description (no connection needed) */
+BRIDGE_API uint32_t bridge_abi_version(void);
+BRIDGE_API const char* bridge_schema_name(void);
+BRIDGE_API size_t bridge_segment_size(void);
+BRIDGE_API const bridge_field* bridge_fields(uint32_t* count);
+BRIDGE_API int32_t bridge_field_index(const char* name);   /* -1 if unknown */
+BRIDGE_API uint32_t bridge_life_plc_offset(void);         /* LifeCPP follows at +4 */
+BRIDGE_API uint32_t bridge_layout_hash(void);             /* Expected header LayoutHash */
+
+/* Connection; memory_name NULL selects the default segment name */
+BRIDGE_API bridge_client* bridge_connect(const char* memory_name);
+BRIDGE_API void bridge_disconnect(bridge_client* client);
+
+/*
+ * Attach epoch of the client, 0 once the PLC switched to another layout
+ * Changes whenever bridge_sync remaps the segment or the PLC re-initializes
+ * it. Pointers from bridge_data / bridge_view are valid until
+ * bridge_disconnect or until the generation changes.
+ */
+BRIDGE_API uint32_t bridge_generation(bridge_client* client);
+
+/* Raw segment start */
+BRIDGE_API void* bridge_data(bridge_client* client);
+
+/*
+ * Zero-copy view of 'count' consecutive fields starting at 'first'
+ * Returns the address of the first element and stores the distance between
+ * elements in *stride, or NULL if the fields differ in type or spacing.
+ */
+BRIDGE_API void* bridge_view(bridge_client* client, uint32_t first, uint32_t count, uint32_t* stride);
+
+/* Heartbeats */
+BRIDGE_API void bridge_heartbeat(bridge_client* client, int32_t* life_plc, int32_t* life_cpp);
+BRIDGE_API int bridge_is_plc_active(bridge_client* client);
+BRIDGE_API void bridge_sync(bridge_client* client);
+
+/*
+ * Copy the whole segment into 'buffer' (at least bridge_segment_size() bytes)
+ * Best effort: the copy is retried while LifePLC moves. Returns 1 if LifePLC
+ * did not change during the copy, 0 if it kept changing, -1 on error. The
+ * PLC writes ToCPP without a sequence counter, so a copy taken while it is
+ * partway through one cycle's writes is not detected either way.
+ */
+BRIDGE_API int bridge_snapshot(bridge_client* client, void* buffer, size_t size);
+
+/*
+ * Write FromCPP of a bridge_snapshot() image back (episode resets)
+ * ToCPP belongs to the PLC and is left alone; header, heartbeats and lockstep
+ * counters stay live; LifeCPP advances.
+ * Returns 0, or -1 on error (including a snapshot of another layout).
+ */
+BRIDGE_API int bridge_restore(bridge_client* client, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BRIDGE_CAPI_H */
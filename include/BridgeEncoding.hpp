@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Quantized Transport Encodings
+ *
+ * Variables declared with an "encoding" travel through the segment as a
+ * compact raw type and are converted to engineering units by the client:
+ *
+ *   engineering = raw * scale + offset
+ *
+ * Raw values may be unaligned (packed layouts), so bulk conversions load and
+ * store through memcpy, which compilers turn into plain (vectorized) moves.
+ */
+
+namespace BridgeEncoding {
+
+/**
+ * Engineering value -> raw value (rounded and saturated for integer types)
+ */
+template<typename Raw>
+inline Raw Quantize(double value, double scale, double offset) {
+    double scaled = (value - offset) / scale;
+    if (std::is_floating_point<Raw>::value) return static_cast<Raw>(scaled);
+
+    const double lo = static_cast<double>(std::numeric_limits<Raw>::min());
+    const double hi = static_cast<double>(std::numeric_limits<Raw>::max());
+    if (!(scaled >= lo)) return std::numeric_limits<Raw>::min();   // also catches NaN
+    if (scaled >= hi) return std::numeric_limits<Raw>::max();
+    return static_cast<Raw>(std::llround(scaled));
+}
+
+/**
+ * Raw value -> engineering value
+ */
+template<typename Raw>
+inline double Dequantize(Raw raw, double scale, double offset) {
+    return static_cast<double>(raw) * scale + offset;
+}
+
+/**
+ * Decode a run of consecutive raw fields
+ * @param raw Address of the first raw field (may be unaligned)
+ * @param scale, offset Per-field conversion factors
+ * @param out Engineering values
+ */
+template<typename Raw>
+inline void DecodeRun(const void* raw, size_t count, const double* scale, const double* offset, double* out) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(raw);
+    for (size_t i = 0; i < count; i++) {
+        Raw r;
+        std::memcpy(&r, bytes + i * sizeof(Raw), sizeof(Raw));
+        out[i] = static_cast<double>(r) * scale[i] + offset[i];
+    }
+}
+
+/**
+ * Encode a run of consecutive raw fields
+ * @param in Engineering values
+ * @param raw Address of the first raw field (may be unaligned)
+ */
+template<typename Raw>
+inline void EncodeRun(const double* in, size_t count, const double* scale, const double* offset, void* raw) {
+    unsigned char* bytes = static_cast<unsigned char*>(raw);
+    for (size_t i = 0; i < count; i++) {
+        Raw r = Quantize<Raw>(in[i], scale[i], offset[i]);
+        std::memcpy(bytes + i * sizeof(Raw), &r, sizeof(Raw));
+    }
+}
+
+/**
+ * Packed BOOL groups ("bitGroup"): words of up to 64 bits, bit i of the
+ * group is bit i % width of word i / width
+ */
+inline unsigned PopCount(uint64_t word) {
+#ifdef _MSC_VER
+    return static_cast<unsigned>(__popcnt64(word));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#endif
+}
+
+// Index of the lowest set bit, word must not be 0
+inline unsigned LowestBit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+template<typename Word>
+inline size_t CountBits(const Word* words, size_t count) {
+    size_t bits = 0;
+    for (size_t w = 0; w < count; w++) bits += PopCount(words[w]);
+    return bits;
+}
+
+/**
+ * f(bit) for every set bit, lowest first
+ */
+template<typename Word, typename F>
+inline void ForEachSetBit(const Word* words, size_t count, F f) {
+    for (size_t w = 0; w < count; w++) {
+        for (uint64_t rest = words[w]; rest != 0; rest &= rest - 1) f(w * sizeof(Word) * 8 + LowestBit(rest));
+    }
+}
+
+/**
+ * f(bit, value) for every bit that differs from 'previous', which is updated
+ * @return Number of changed bits
+ */
+template<typename Word, typename F>
+inline size_t ForEachChangedBit(const Word* words, Word* previous, size_t count, F f) {
+    size_t changed = 0;
+    for (size_t w = 0; w < count; w++) {
+        uint64_t diff = static_cast<uint64_t>(words[w] ^ previous[w]);
+        if (diff == 0) continue;
+        changed += PopCount(diff);
+        for (; diff != 0; diff &= diff - 1) {
+            unsigned bit = LowestBit(diff);
+            f(w * sizeof(Word) * 8 + bit, ((words[w] >> bit) & 1) != 0);
+        }
+        previous[w] = words[w];
+    }
+    return changed;
+}
+
+} // namespace BridgeEncoding
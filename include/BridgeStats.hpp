@@ -0,0 +1,180 @@
+#pragma once
+
+#include "GenericSharedMemory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/**
+ * Windowed Statistics Segment
+ *
+ * Variables declared with "stats": true are aggregated by the controller
+ * into min/max/mean/RMS per window and published into a separate, small
+ * segment (ST_<Name>Stats, named <memory name>_stats). Dashboards attach
+ * to that segment instead of polling the control mapping, so any number of
+ * monitors costs the control loop nothing.
+ *
+ * ST_<Name>Stats provides Count, LayoutHash and the members
+ *   Header, Seq, Window, Samples, WindowMs, EndMs, Fields[Count]
+ * Seq is odd while a window is being written; Reader::Read retries until it
+ * copies an even, unchanged Seq.
+ */
+
+namespace BridgeStats {
+
+/**
+ * Running min/max/sum/sum of squares over equally long sample vectors
+ * Plain loops over the channel arrays, which compilers vectorize.
+ */
+class Accumulator {
+public:
+    explicit Accumulator(size_t channels)
+        : minimum(channels), maximum(channels), sum(channels), sumSq(channels), samples(0) {
+        Reset();
+    }
+
+    void Reset() {
+        std::fill(minimum.begin(), minimum.end(), std::numeric_limits<double>::infinity());
+        std::fill(maximum.begin(), maximum.end(), -std::numeric_limits<double>::infinity());
+        std::fill(sum.begin(), sum.end(), 0.0);
+        std::fill(sumSq.begin(), sumSq.end(), 0.0);
+        samples = 0;
+    }
+
+    void Add(const double* values) {
+        const size_t n = sum.size();
+        double* mn = minimum.data();
+        double* mx = maximum.data();
+        double* s = sum.data();
+        double* sq = sumSq.data();
+        for (size_t i = 0; i < n; i++) {
+            double v = values[i];
+            mn[i] = v < mn[i] ? v : mn[i];
+            mx[i] = v > mx[i] ? v : mx[i];
+            s[i] += v;
+            sq[i] += v * v;
+        }
+        samples++;
+    }
+
+    size_t Samples() const { return samples; }
+
+    /**
+     * Store the window into an array of {Min, Max, Mean, Rms} records
+     */
+    template<typename Record>
+    void Store(Record* out) const {
+        const double inv = samples ? 1.0 / static_cast<double>(samples) : 0.0;
+        for (size_t i = 0; i < sum.size(); i++) {
+            out[i].Min = samples ? minimum[i] : 0.0;
+            out[i].Max = samples ? maximum[i] : 0.0;
+            out[i].Mean = sum[i] * inv;
+            out[i].Rms = std::sqrt(sumSq[i] * inv);
+        }
+    }
+
+private:
+    std::vector<double> minimum, maximum, sum, sumSq;
+    size_t samples;
+};
+
+/**
+ * Owner side: aggregates one sample per cycle, publishes each full window
+ */
+template<typename TStats>
+class Publisher {
+public:
+    explicit Publisher(double windowMs) : accumulator(TStats::Count), windowMs(windowMs), windowStart(-1.0) {}
+
+    bool Create(const wchar_t* name) {
+        segment.SetTransport("shm");        // Monitors are local even for split-host bridges
+        segment.SetHeader(TStats::LayoutHash);
+        if (!segment.Create(name, sizeof(TStats))) return false;
+        TStats* s = data();
+        s->WindowMs = windowMs;
+        return true;
+    }
+
+    bool IsConnected() const { return segment.IsConnected(); }
+
+    /**
+     * @param values TStats::Count values of this cycle
+     * @param nowMs Time stamp of the sample (simulation time in the controller)
+     */
+    void Add(const double* values, double nowMs) {
+        if (windowStart < 0.0 || nowMs < windowStart) {
+            accumulator.Reset();
+            windowStart = nowMs;
+        }
+        if (nowMs - windowStart >= windowMs && accumulator.Samples() > 0) {
+            publish(windowStart + windowMs);
+            accumulator.Reset();
+            windowStart += windowMs * std::floor((nowMs - windowStart) / windowMs);
+        }
+        accumulator.Add(values);
+    }
+
+private:
+    TStats* data() const { return static_cast<TStats*>(segment.GetPointer()); }
+
+    void publish(double endMs) {
+        TStats* s = data();
+        if (!s) return;
+        volatile UDINT* seq = &s->Seq;
+        *seq = *seq + 1;
+        std::atomic_thread_fence(std::memory_order_release);
+        accumulator.Store(s->Fields);
+        s->Samples = static_cast<UDINT>(accumulator.Samples());
+        s->EndMs = endMs;
+        s->Window = s->Window + 1;
+        std::atomic_thread_fence(std::memory_order_release);
+        *seq = *seq + 1;
+    }
+
+    GenericSharedMemory segment;
+    Accumulator accumulator;
+    double windowMs;
+    double windowStart;
+};
+
+/**
+ * Monitor side: read-only consistent copies of the last window
+ */
+template<typename TStats>
+class Reader {
+public:
+    bool Connect(const wchar_t* name) {
+        segment.SetTransport("shm");
+        segment.SetHeader(TStats::LayoutHash);
+        return segment.Connect(name, sizeof(TStats));
+    }
+
+    GenericSharedMemory::Status GetStatus() const { return segment.GetStatus(); }
+
+    /**
+     * Copy the last published window
+     * @return false if not connected or the writer kept it busy
+     */
+    bool Read(TStats& out, int attempts = 100) const {
+        const TStats* s = static_cast<const TStats*>(segment.GetPointer());
+        if (!s) return false;
+        const volatile UDINT* seq = &s->Seq;
+        for (int i = 0; i < attempts; i++) {
+            UDINT before = *seq;
+            if (before & 1u) continue;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::memcpy(static_cast<void*>(&out), s, sizeof(TStats));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (*seq == before) return true;
+        }
+        return false;
+    }
+
+private:
+    GenericSharedMemory segment;
+};
+
+} // namespace BridgeStats
@@ -0,0 +1,341 @@
+#pragma once
+
+// Before anything pulls in windows.h: BridgeEncoding uses numeric_limits<>::min/max
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+#endif
+
+#include "BridgeEncoding.hpp"
+#include "UnifiedCodeGenerator.hpp"
+#include "GenericSharedMemory.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Dynamic Bridge Client
+ *
+ * Attaches to the segment of any schema without a generated client: the
+ * schema is loaded at startup and laid out by the generator itself, so
+ * offsets and the layout fingerprint are the ones the generated types use.
+ *
+ *   DynamicBridgeClient client("schemas/ur10e.json");
+ *   DynamicBridgeClient::Handle elbow = client.Require("elbow_joint");
+ *   client.Connect(L"OKZiJMksN52vWF53");
+ *   double q = client.Get(elbow);
+ *
+ * Names are resolved once into handles (offset, storage kind, encoding,
+ * bit mask). Reads and writes through a handle are a memcpy at a fixed
+ * offset plus one switch on the kind and return defaults while
+ * disconnected, like the generated client; Read<T>/Write<T> skip both the
+ * switch and the connection check when the caller knows the storage type. Gather/Scatter move lists of
+ * handles to and from double arrays.
+ *
+ * Uses only fixed-width types, not CodesysTypes.hpp, so it can be mixed
+ * with windows.h and with generated headers of other schemas.
+ */
+class DynamicBridgeClient : public GenericSharedMemory {
+public:
+    enum Kind : uint8_t {
+        KIND_INVALID, KIND_BOOL, KIND_BIT,
+        KIND_I8, KIND_U8, KIND_I16, KIND_U16, KIND_I32, KIND_U32, KIND_I64, KIND_U64,
+        KIND_F32, KIND_F64, KIND_STRING
+    };
+
+    /**
+     * Resolved field: trivially copyable, valid for any client of the same schema
+     */
+    struct Handle {
+        uint32_t offset = 0;    // Absolute offset in the segment (bits: their word)
+        uint32_t size = 0;      // Bytes in the segment (bits: word size)
+        Kind kind = KIND_INVALID;
+        bool toCPP = false;
+        uint64_t mask = 0;      // Bit of a packed BOOL in its word
+        double scale = 1.0;     // Engineering = raw * scale + bias
+        double bias = 0.0;
+
+        bool Valid() const { return kind != KIND_INVALID; }
+    };
+
+    /**
+     * Load a schema with the options it declares (layout, lockstep, ...)
+     * @throws std::runtime_error like the generator for invalid schemas
+     */
+    explicit DynamicBridgeClient(const std::string& schemaPath) {
+        UnifiedCodeGenerator gen;
+        gen.loadSchema(schemaPath);
+        describe(gen);
+    }
+
+    /**
+     * Use a loaded generator, e.g. with command line options applied
+     * ("layoutMode", "lockstep", "layoutOptimization")
+     */
+    explicit DynamicBridgeClient(UnifiedCodeGenerator& gen) {
+        describe(gen);
+    }
+
+    bool Connect(const wchar_t* name) {
+        SetLayout(fromCPPOffset, lifePLCOffset);
+        SetHeader(layoutHash);
+        return GenericSharedMemory::Connect(name, segmentSize);
+    }
+
+    /**
+     * Create the segment as its owner (test rigs standing in for the PLC)
+     */
+    bool Create(const wchar_t* name) {
+        SetLayout(fromCPPOffset, lifePLCOffset);
+        SetHeader(layoutHash);
+        return GenericSharedMemory::Create(name, segmentSize);
+    }
+
+    const std::string& SchemaName() const { return schemaName; }
+    size_t SegmentSize() const { return segmentSize; }
+    uint32_t LayoutHash() const { return layoutHash; }
+
+    // Field names in segment order (packed bits after the fields)
+    const std::vector<std::string>& Names() const { return names; }
+
+    /**
+     * Handle of a variable, invalid (Valid() == false) if the schema has none
+     */
+    Handle Find(const std::string& name) const {
+        auto it = index.find(name);
+        return it == index.end() ? Handle() : it->second;
+    }
+
+    /**
+     * Handle of a variable
+     * @throws std::runtime_error for unknown names
+     */
+    Handle Require(const std::string& name) const {
+        auto it = index.find(name);
+        if (it == index.end()) throw std::runtime_error("Unknown variable: " + name + " (" + schemaName + ")");
+        return it->second;
+    }
+
+    std::vector<Handle> RequireAll(const std::vector<std::string>& list) const {
+        std::vector<Handle> handles;
+        handles.reserve(list.size());
+        for (const auto& name : list) handles.push_back(Require(name));
+        return handles;
+    }
+
+    /**
+     * Raw access when the storage type is known (T must have the field's size)
+     * Unchecked: the caller ensures IsConnected() and a valid handle.
+     */
+    template<typename T>
+    T Read(const Handle& h) const {
+        T value;
+        std::memcpy(&value, base() + h.offset, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void Write(const Handle& h, T value) {
+        std::memcpy(base() + h.offset, &value, sizeof(T));
+    }
+
+    /**
+     * Value of a numeric or BOOL field in engineering units
+     */
+    double Get(const Handle& h) const {
+        if (!IsConnected()) return 0.0;
+        const unsigned char* p = base() + h.offset;
+        switch (h.kind) {
+        case KIND_BOOL: return p[0] ? 1.0 : 0.0;
+        case KIND_BIT:  return (word(p, h.size) & h.mask) ? 1.0 : 0.0;
+        case KIND_I8:   return BridgeEncoding::Dequantize(load<int8_t>(p), h.scale, h.bias);
+        case KIND_U8:   return BridgeEncoding::Dequantize(load<uint8_t>(p), h.scale, h.bias);
+        case KIND_I16:  return BridgeEncoding::Dequantize(load<int16_t>(p), h.scale, h.bias);
+        case KIND_U16:  return BridgeEncoding::Dequantize(load<uint16_t>(p), h.scale, h.bias);
+        case KIND_I32:  return BridgeEncoding::Dequantize(load<int32_t>(p), h.scale, h.bias);
+        case KIND_U32:  return BridgeEncoding::Dequantize(load<uint32_t>(p), h.scale, h.bias);
+        case KIND_I64:  return BridgeEncoding::Dequantize(load<int64_t>(p), h.scale, h.bias);
+        case KIND_U64:  return BridgeEncoding::Dequantize(load<uint64_t>(p), h.scale, h.bias);
+        case KIND_F32:  return BridgeEncoding::Dequantize(load<float>(p), h.scale, h.bias);
+        case KIND_F64:  return BridgeEncoding::Dequantize(load<double>(p), h.scale, h.bias);
+        default:        return 0.0;
+        }
+    }
+
+    /**
+     * Store a numeric or BOOL field; integers are rounded and saturated,
+     * bits are set without touching the rest of their word
+     */
+    void Set(const Handle& h, double value) {
+        if (!IsConnected()) return;
+        unsigned char* p = base() + h.offset;
+        switch (h.kind) {
+        case KIND_BOOL: p[0] = value != 0.0 ? 1 : 0; break;
+        case KIND_BIT: {
+            uint64_t w = word(p, h.size);
+            w = value != 0.0 ? (w | h.mask) : (w & ~h.mask);
+            if (h.size == 4) store(p, static_cast<uint32_t>(w));
+            else store(p, w);
+            break;
+        }
+        case KIND_I8:   store(p, BridgeEncoding::Quantize<int8_t>(value, h.scale, h.bias)); break;
+        case KIND_U8:   store(p, BridgeEncoding::Quantize<uint8_t>(value, h.scale, h.bias)); break;
+        case KIND_I16:  store(p, BridgeEncoding::Quantize<int16_t>(value, h.scale, h.bias)); break;
+        case KIND_U16:  store(p, BridgeEncoding::Quantize<uint16_t>(value, h.scale, h.bias)); break;
+        case KIND_I32:  store(p, BridgeEncoding::Quantize<int32_t>(value, h.scale, h.bias)); break;
+        case KIND_U32:  store(p, BridgeEncoding::Quantize<uint32_t>(value, h.scale, h.bias)); break;
+        case KIND_I64:  store(p, BridgeEncoding::Quantize<int64_t>(value, h.scale, h.bias)); break;
+        case KIND_U64:  store(p, BridgeEncoding::Quantize<uint64_t>(value, h.scale, h.bias)); break;
+        case KIND_F32:  store(p, BridgeEncoding::Quantize<float>(value, h.scale, h.bias)); break;
+        case KIND_F64:  store(p, BridgeEncoding::Quantize<double>(value, h.scale, h.bias)); break;
+        default: break;
+        }
+    }
+
+    std::string GetString(const Handle& h) const {
+        if (!IsConnected() || h.kind != KIND_STRING) return std::string();
+        const char* p = reinterpret_cast<const char*>(base() + h.offset);
+        return std::string(p, strnlen(p, h.size));
+    }
+
+    /**
+     * Store a STRING field, truncated to its declared size and terminated
+     */
+    void SetString(const Handle& h, const std::string& value) {
+        if (!IsConnected() || h.kind != KIND_STRING || h.size == 0) return;
+        char* p = reinterpret_cast<char*>(base() + h.offset);
+        size_t n = value.size() < h.size - 1 ? value.size() : h.size - 1;
+        std::memcpy(p, value.data(), n);
+        std::memset(p + n, 0, h.size - n);
+    }
+
+    /**
+     * Bulk reads/writes of handle lists in engineering units
+     */
+    void Gather(const Handle* handles, size_t count, double* out) const {
+        for (size_t i = 0; i < count; i++) out[i] = Get(handles[i]);
+    }
+
+    void Gather(const std::vector<Handle>& handles, double* out) const {
+        Gather(handles.data(), handles.size(), out);
+    }
+
+    void Scatter(const Handle* handles, size_t count, const double* in) {
+        for (size_t i = 0; i < count; i++) Set(handles[i], in[i]);
+    }
+
+    void Scatter(const std::vector<Handle>& handles, const double* in) {
+        Scatter(handles.data(), handles.size(), in);
+    }
+
+    /**
+     * Consistent copy of the whole segment (retried while LifePLC moves)
+     * @return false if the copy may be torn
+     */
+    bool Snapshot(std::vector<unsigned char>& image) const {
+        image.resize(segmentSize);
+        if (!IsConnected()) return false;
+        const volatile int32_t* life = reinterpret_cast<const volatile int32_t*>(base() + lifePLCOffset);
+        for (int attempt = 0; attempt < 8; attempt++) {
+            int32_t before = *life;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::memcpy(image.data(), base(), segmentSize);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (*life == before) return true;
+        }
+        return false;
+    }
+
+    int32_t LifePLC() const { return IsConnected() ? load<int32_t>(base() + lifePLCOffset) : 0; }
+    int32_t LifeCPP() const { return IsConnected() ? load<int32_t>(base() + lifePLCOffset + 4) : 0; }
+
+private:
+    unsigned char* base() const { return static_cast<unsigned char*>(GetPointer()); }
+
+    template<typename T>
+    static T load(const unsigned char* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    static void store(unsigned char* p, T value) {
+        std::memcpy(p, &value, sizeof(T));
+    }
+
+    static uint64_t word(const unsigned char* p, uint32_t size) {
+        return size == 4 ? load<uint32_t>(p) : load<uint64_t>(p);
+    }
+
+    static Kind kindOf(const std::string& t) {
+        if (t == "BOOL") return KIND_BOOL;
+        if (t == "SINT") return KIND_I8;
+        if (t == "BYTE" || t == "USINT") return KIND_U8;
+        if (t == "INT") return KIND_I16;
+        if (t == "WORD" || t == "UINT") return KIND_U16;
+        if (t == "DINT") return KIND_I32;
+        if (t == "REAL") return KIND_F32;
+        if (t == "LREAL") return KIND_F64;
+        if (t == "STRING") return KIND_STRING;
+        if (t == "LINT") return KIND_I64;
+        if (t == "LWORD" || t == "ULINT" || t == "LTIME" || t == "LDATE" || t == "LTIME_OF_DAY" ||
+            t == "LTOD" || t == "LDATE_AND_TIME" || t == "LDT") return KIND_U64;
+        return KIND_U32;    // DWORD, UDINT, TIME, DATE, TOD, DT
+    }
+
+    // Same layout pass as generateAll, then one handle per variable and packed bit
+    void describe(UnifiedCodeGenerator& gen) {
+        if (gen.layoutOptimization) gen.optimizeLayout();
+        gen.buildModel();
+        const UnifiedCodeGenerator::Model& m = gen.model();
+        const UnifiedCodeGenerator::SegmentLayout& layout = m.layout;
+
+        schemaName = gen.memoryName;
+        segmentSize = layout.totalSize;
+        fromCPPOffset = layout.fromCPPOffset;
+        lifePLCOffset = layout.lifePLCOffset;
+        layoutHash = m.layoutHash;
+
+        index.reserve(layout.fields.size());
+        names.reserve(layout.fields.size());
+        for (size_t i = 0; i < layout.fields.size(); i++) {
+            const UnifiedCodeGenerator::FieldSlot& slot = layout.fields[i];
+            const UnifiedCodeGenerator::Variable& v = gen.variables[i];
+            Handle h;
+            h.offset = static_cast<uint32_t>(slot.offset);
+            h.size = static_cast<uint32_t>(slot.size);
+            h.kind = kindOf(slot.type);
+            h.toCPP = slot.direction == "toCPP";
+            if (!v.encoding.empty()) {
+                h.scale = v.encodingScale;
+                h.bias = v.encodingOffset;
+            }
+            index[slot.name] = h;
+            names.push_back(slot.name);
+        }
+        for (const auto& g : gen.bitGroups) {
+            for (const auto& bit : g.bits) {
+                Handle h = index.at(UnifiedCodeGenerator::bitWordName(g.name, bit.bitIndex / g.wordBits));
+                h.kind = KIND_BIT;
+                h.mask = 1ull << (bit.bitIndex % g.wordBits);
+                index[bit.name] = h;
+                names.push_back(bit.name);
+            }
+        }
+    }
+
+    std::string schemaName;
+    size_t segmentSize = 0;
+    size_t fromCPPOffset = 0;
+    size_t lifePLCOffset = 0;
+    uint32_t layoutHash = 0;
+    std::unordered_map<std::string, Handle> index;
+    std::vector<std::string> names;
+};
@@ -1,42 +1,193 @@
 #pragma once
 
-// Windows API for shared memory
+// Windows API for shared memory, POSIX shm elsewhere
 #ifdef _WIN32
   #define WIN32_LEAN_AND_MEAN
   #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
 #endif
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "UdpTransport.hpp"
 
 /**
  * Generic Shared Memory Library
- * 
+ *
  * Template-based library that works with ANY structure size.
  * No hardcoded types - fully reusable!
- * 
+ *
  * Note: Uses native C++ types internally to avoid Windows.h conflicts.
  * The CodesysTypes.hpp is included only by the generated types.
+ *
+ * Transport selection (no regeneration needed):
+ *   CODESYS_BRIDGE_TRANSPORT unset or "shm"  -> local shared memory (default)
+ *   CODESYS_BRIDGE_TRANSPORT="udp://host:port?bind=port" -> UDP frames to a
+ *   relay on the PLC host (see <name>_udp_relay.cpp)
+ *
+ * Segment header (see SetHeader): generated segments start with
+ * {Magic, LayoutHash, Generation, Size}. Connect rejects a segment laid out
+ * for a different schema, and Sync follows the PLC when it re-initializes or
+ * recreates the segment (new Generation), remapping without a restart.
+ * GetGeneration() is a local epoch that changes on every such event, so
+ * pointers into the old mapping can be told stale even if the PLC wrote
+ * the same Generation again.
+ *
+ * Inspectors attach with SetReadOnly(true): the mapping has no write access
+ * and Sync only follows restarts, so they never touch a line the PLC or the
+ * controller owns.
+ *
+ * Writers of a partition (ST_FromCPP_<Writer>) attach with SetHeartbeat:
+ * Sync then advances the partition's Life instead of LifeCPP, so several
+ * processes publish into one segment without sharing a heartbeat. Over
+ * UDP a writer Shares the controller's mapping instead, so its partition
+ * travels in the controller's frames. Helpers next to the controller (the
+ * physics plugin) SetHeartbeatEnabled(false).
  */
 
 class GenericSharedMemory {
+public:
+    static const uint32_t HEADER_MAGIC = 0x31425743u;   // "CWB1"
+
+    enum Status {
+        DISCONNECTED,
+        CONNECTED,
+        NOT_READY,          // Segment exists but its header is not initialized yet
+        LAYOUT_MISMATCH     // Segment belongs to a different layout, regenerate
+    };
+
 private:
-    HANDLE hMapFile;
+#ifdef _WIN32
+    typedef HANDLE MapHandle;
+#else
+    typedef int MapHandle;
+#endif
+    MapHandle hMapFile;
     void* pData;
     size_t dataSize;
     bool connected;
     int32_t* pLifePLC;
     int32_t* pLifeCPP;
     int32_t lastLifePLC;
+    bool owner;                 // Segment created by this instance (see Create)
+    bool readOnly;              // Mapped without write access (see SetReadOnly)
+    bool heartbeatEnabled;      // Sync advances the heartbeat (see SetHeartbeatEnabled)
+    std::string ownerName;
+
+    // Network transport (split-host deployments)
+    std::string transportUri;
+    size_t fromCPPOffset;
+    size_t lifePLCOffset;       // 0 = last 8 bytes of the structure
+    size_t heartbeatOffset;     // Counter advanced by Sync, 0 = LifeCPP
+    std::unique_ptr<UdpTransport> transport;
+    std::vector<char> localImage;
+    const GenericSharedMemory* source;  // Mapping written through (see Share), nullptr = own
+
+    // Segment header checks (SetHeader)
+    bool checkHeader;
+    uint32_t layoutHash;
+    uint32_t generation;        // Header Generation of the attached segment
+    uint32_t epoch;             // Local attach epoch, see GetGeneration
+    Status status;
+    std::wstring segmentName;
+    int32_t watchedLife;
+    uint32_t syncCount;
+    std::chrono::steady_clock::time_point lastProbe;
+#ifndef _WIN32
+    dev_t segmentDev;
+    ino_t segmentIno;
+#endif
 
 public:
-    GenericSharedMemory() 
-        : hMapFile(NULL), pData(nullptr), dataSize(0), connected(false),
-          pLifePLC(nullptr), pLifeCPP(nullptr), lastLifePLC(0) {}
+    GenericSharedMemory()
+#ifdef _WIN32
+        : hMapFile(NULL),
+#else
+        : hMapFile(-1),
+#endif
+          pData(nullptr), dataSize(0), connected(false),
+          pLifePLC(nullptr), pLifeCPP(nullptr), lastLifePLC(0), owner(false), readOnly(false), heartbeatEnabled(true),
+          fromCPPOffset(0), lifePLCOffset(0), heartbeatOffset(0), source(nullptr),
+          checkHeader(false), layoutHash(0), generation(0), epoch(0), status(DISCONNECTED),
+          watchedLife(0), syncCount(0)
+#ifndef _WIN32
+          , segmentDev(0), segmentIno(0)
+#endif
+          {}
 
     ~GenericSharedMemory() {
-        if (pData) UnmapViewOfFile(pData);
-        if (hMapFile) CloseHandle(hMapFile);
+        Disconnect();
+    }
+
+    GenericSharedMemory(const GenericSharedMemory&) = delete;
+    GenericSharedMemory& operator=(const GenericSharedMemory&) = delete;
+
+    /**
+     * Select the transport explicitly (overrides CODESYS_BRIDGE_TRANSPORT)
+     * @param uri "shm" or "udp://host:port?bind=port"
+     */
+    void SetTransport(const std::string& uri) {
+        transportUri = uri;
+    }
+
+    /**
+     * Attach read-only (monitors, inspectors); applies to the next Connect
+     * Always local shared memory; Sync then follows PLC restarts without
+     * advancing LifeCPP. Writing through GetPointer() faults.
+     */
+    void SetReadOnly(bool value) {
+        readOnly = value;
+    }
+
+    /**
+     * Describe the structure layout
+     * @param fromCPP Offset of the FromCPP block (splits PLC-owned and
+     *                C++-owned ranges for network transports)
+     * @param lifePLC Offset of LifePLC, LifeCPP follows it (default: last 8 bytes)
+     */
+    void SetLayout(size_t fromCPP, size_t lifePLC) {
+        fromCPPOffset = fromCPP;
+        lifePLCOffset = lifePLC;
+    }
+
+    /**
+     * Advance the DINT at 'offset' on Sync instead of LifeCPP
+     * Used by partition writers, whose Life sits in their own block.
+     */
+    void SetHeartbeat(size_t offset) {
+        heartbeatOffset = offset;
+    }
+
+    /**
+     * Leave the heartbeat to another process
+     * Sync then still follows PLC restarts (and exchanges UDP frames) but
+     * advances no counter, so liveness stays with a single writer.
+     */
+    void SetHeartbeatEnabled(bool value) {
+        heartbeatEnabled = value;
+    }
+
+    /**
+     * Expect a segment header at offset 0 (generated ST_<Name>::LayoutHash)
+     * Connect then fails with LAYOUT_MISMATCH for a segment of another
+     * layout, and Create initializes the header as the owner.
+     */
+    void SetHeader(uint32_t hash) {
+        checkHeader = true;
+        layoutHash = hash;
     }
 
     /**
@@ -49,8 +200,56 @@ public:
         if (connected) return true;
 
         dataSize = size;
-        
-        hMapFile = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name);
+        if (lifePLCOffset == 0 || lifePLCOffset + 8 > dataSize) lifePLCOffset = dataSize - 8;
+
+        std::string uri = transportUri;
+        if (uri.empty()) {
+            const char* env = std::getenv("CODESYS_BRIDGE_TRANSPORT");
+            if (env) uri = env;
+        }
+        if (!readOnly && !uri.empty() && uri != "shm") {
+            return connectUdp(uri);
+        }
+
+        status = DISCONNECTED;
+        if (!openSegment(name, hMapFile, pData)) return false;
+        if (checkHeader && !acceptHeader(pData)) {
+            closeSegment(hMapFile, pData);
+            return false;
+        }
+        segmentName = name;
+#ifndef _WIN32
+        segmentIdentity(hMapFile, segmentDev, segmentIno);
+#endif
+
+        // Calculate heartbeat positions (last 8 bytes unless SetLayout says otherwise)
+        bindHeartbeats(static_cast<char*>(pData));
+        watchedLife = *pLifePLC;
+
+        nextEpoch();
+        status = CONNECTED;
+        connected = true;
+        return true;
+    }
+
+    /**
+     * Create (or open) the segment as its owner, zero-initialized when new
+     * Used by the virtual PLC and benchmarks; the CODESYS runtime normally
+     * owns the segment.
+     * @param name Shared memory name
+     * @param size Total size of structure in bytes
+     * @return true if the segment is mapped
+     */
+    bool Create(const wchar_t* name, size_t size) {
+        if (connected) return true;
+
+        dataSize = size;
+        if (lifePLCOffset == 0 || lifePLCOffset + 8 > dataSize) lifePLCOffset = dataSize - 8;
+
+#ifdef _WIN32
+        hMapFile = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(dataSize) >> 32),
+                                      static_cast<DWORD>(dataSize & 0xFFFFFFFFu), name);
         if (!hMapFile) return false;
 
         pData = MapViewOfFile(hMapFile, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, dataSize);
@@ -59,20 +258,86 @@ public:
             hMapFile = NULL;
             return false;
         }
+#else
+        ownerName = PosixName(name);
+        hMapFile = shm_open(ownerName.c_str(), O_CREAT | O_RDWR, 0666);
+        if (hMapFile < 0) return false;
+
+        struct stat st;
+        if (fstat(hMapFile, &st) != 0 ||
+            (static_cast<size_t>(st.st_size) < dataSize && ftruncate(hMapFile, static_cast<off_t>(dataSize)) != 0)) {
+            close(hMapFile);
+            hMapFile = -1;
+            return false;
+        }
 
-        // Calculate heartbeat positions (last 8 bytes)
-        pLifePLC = reinterpret_cast<int32_t*>(static_cast<char*>(pData) + dataSize - 8);
-        pLifeCPP = reinterpret_cast<int32_t*>(static_cast<char*>(pData) + dataSize - 4);
-        
+        pData = mmap(nullptr, dataSize, PROT_READ | PROT_WRITE, MAP_SHARED, hMapFile, 0);
+        if (pData == MAP_FAILED) {
+            pData = nullptr;
+            close(hMapFile);
+            hMapFile = -1;
+            return false;
+        }
+        owner = true;
+#endif
+
+        bindHeartbeats(static_cast<char*>(pData));
+        if (checkHeader) initHeader();
+
+        nextEpoch();
+        status = CONNECTED;
         connected = true;
         return true;
     }
 
+    /**
+     * Write through the mapping of another instance instead of one's own
+     * For partition writers over UDP: the fields land in the image of
+     * 'mapping' and travel with its Sync, which also follows PLC restarts;
+     * Sync here only advances the heartbeat. Valid while 'mapping' lives.
+     * @return false if 'mapping' is not connected or has another size
+     */
+    bool Share(const GenericSharedMemory& mapping, size_t size) {
+        Disconnect();
+        if (!mapping.IsConnected() || mapping.GetSize() != size) return false;
+        dataSize = size;
+        if (lifePLCOffset == 0 || lifePLCOffset + 8 > dataSize) lifePLCOffset = dataSize - 8;
+        source = &mapping;
+        status = CONNECTED;
+        return true;
+    }
+
+    /**
+     * Release the mapping (or network transport); Connect may be called again
+     * An owner (see Create) also removes the segment name on POSIX.
+     */
+    void Disconnect() {
+        if (transport) {
+            transport.reset();
+            localImage.clear();
+        } else {
+            closeSegment(hMapFile, pData);
+#ifndef _WIN32
+            if (owner) shm_unlink(ownerName.c_str());
+#endif
+        }
+        pData = nullptr;
+        pLifePLC = nullptr;
+        pLifeCPP = nullptr;
+        source = nullptr;
+        lastLifePLC = 0;
+        owner = false;
+        connected = false;
+        generation = 0;
+        status = DISCONNECTED;
+        syncCount = 0;
+    }
+
     /**
      * Get raw pointer to shared memory
      */
     void* GetPointer() const {
-        return pData;
+        return source ? source->GetPointer() : pData;
     }
 
     /**
@@ -86,15 +351,61 @@ public:
      * Check if connected
      */
     bool IsConnected() const {
-        return connected;
+        return source ? source->IsConnected() : connected;
+    }
+
+    /**
+     * Connection state, tells a layout mismatch apart from a missing segment
+     */
+    Status GetStatus() const {
+        return status;
+    }
+
+    /**
+     * Attach epoch, 0 while disconnected
+     * Changes whenever the mapping is (re)established or the PLC
+     * re-initializes the segment; pointers from GetPointer() taken under
+     * another epoch must be fetched again.
+     */
+    uint32_t GetGeneration() const {
+        if (source) return source->GetGeneration();
+        return connected ? epoch : 0;
+    }
+
+    /**
+     * Header Generation written by the PLC (0 without a header)
+     */
+    uint32_t GetHeaderGeneration() const {
+        return generation;
+    }
+
+    /**
+     * Network transport in use, nullptr for local shared memory
+     */
+    const UdpTransport* GetTransport() const {
+        return transport.get();
     }
 
     /**
      * Increment C++ heartbeat
+     * With a network transport this also publishes FromCPP and applies
+     * the latest frames received from the PLC host.
      */
     void Sync() {
+        if (source) {
+            if (source->IsConnected() && heartbeatEnabled) {
+                char* base = static_cast<char*>(source->GetPointer());
+                (*reinterpret_cast<int32_t*>(base + (heartbeatOffset ? heartbeatOffset : lifePLCOffset + 4)))++;
+            }
+            return;
+        }
         if (connected && pLifeCPP) {
-            (*pLifeCPP)++;
+            if (!readOnly && heartbeatEnabled) (*pLifeCPP)++;
+            if (transport) {
+                transport->Send(pData);
+                transport->Receive(pData);
+            }
+            if (checkHeader) watchSegment();
         }
     }
 
@@ -103,20 +414,269 @@ public:
      */
     bool IsPLCActive() {
         if (!connected || !pLifePLC) return false;
-        
+        if (transport) transport->Receive(pData);
+
         int32_t current = *pLifePLC;
         bool active = (current != lastLifePLC);
         lastLifePLC = current;
         return active;
     }
+
+#ifndef _WIN32
+    /**
+     * POSIX shared memory object name for a segment name
+     */
+    static std::string PosixName(const wchar_t* name) {
+        std::string result = "/";
+        for (const wchar_t* p = name; *p; ++p) result += static_cast<char>(*p);
+        return result;
+    }
+#endif
+
+private:
+    // Map an existing segment; one smaller than expected is another layout once its header is valid
+    bool openSegment(const wchar_t* name, MapHandle& handle, void*& data) {
+#ifdef _WIN32
+        const DWORD access = readOnly ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE;
+        handle = OpenFileMappingW(access, FALSE, name);
+        if (!handle) return false;
+
+        data = MapViewOfFile(handle, access, 0, 0, dataSize);
+        if (!data) {
+            const void* head = checkHeader ? MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 16) : nullptr;
+            if (head) {
+                if (header(head)[0] == HEADER_MAGIC) status = LAYOUT_MISMATCH;
+                UnmapViewOfFile(head);
+            }
+            CloseHandle(handle);
+            handle = NULL;
+            return false;
+        }
+#else
+        std::string shmName = PosixName(name);
+        handle = shm_open(shmName.c_str(), readOnly ? O_RDONLY : O_RDWR, 0);
+        if (handle < 0) return false;
+
+        struct stat st;
+        if (fstat(handle, &st) != 0 || static_cast<size_t>(st.st_size) < dataSize) {
+            if (checkHeader && st.st_size >= 16) {
+                void* head = mmap(nullptr, 16, PROT_READ, MAP_SHARED, handle, 0);
+                if (head != MAP_FAILED) {
+                    if (header(head)[0] == HEADER_MAGIC) status = LAYOUT_MISMATCH;
+                    munmap(head, 16);
+                }
+            }
+            close(handle);
+            handle = -1;
+            return false;
+        }
+
+        data = mmap(nullptr, dataSize, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+            close(handle);
+            handle = -1;
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    void closeSegment(MapHandle& handle, void*& data) const {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (handle) CloseHandle(handle);
+        handle = NULL;
+#else
+        if (data) munmap(data, dataSize);
+        if (handle >= 0) close(handle);
+        handle = -1;
+#endif
+        data = nullptr;
+    }
+
+    void bindHeartbeats(char* base) {
+        pLifePLC = reinterpret_cast<int32_t*>(base + lifePLCOffset);
+        pLifeCPP = reinterpret_cast<int32_t*>(base + (heartbeatOffset ? heartbeatOffset : lifePLCOffset + 4));
+    }
+
+#ifndef _WIN32
+    static void segmentIdentity(int handle, dev_t& dev, ino_t& ino) {
+        struct stat st;
+        if (fstat(handle, &st) == 0) {
+            dev = st.st_dev;
+            ino = st.st_ino;
+        }
+    }
+#endif
+
+    static const volatile uint32_t* header(const void* data) {
+        return static_cast<const volatile uint32_t*>(data);
+    }
+
+    // Validate {Magic, LayoutHash, Generation, Size} and adopt its generation
+    bool acceptHeader(const void* data) {
+        const volatile uint32_t* h = header(data);
+        if (h[0] != HEADER_MAGIC) {
+            status = NOT_READY;
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h[1] != layoutHash || h[3] != dataSize) {
+            status = LAYOUT_MISMATCH;
+            return false;
+        }
+        generation = h[2];
+        return true;
+    }
+
+    // Owner side: publish the header, Magic last so readers never see a partial one.
+    // Generation comes from the clock so a recreated segment never repeats it.
+    void initHeader() {
+        volatile uint32_t* h = static_cast<volatile uint32_t*>(pData);
+        generation = static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count());
+        if (generation == 0 || generation == h[2]) generation = h[2] + 1;
+        h[1] = layoutHash;
+        h[2] = generation;
+        h[3] = static_cast<uint32_t>(dataSize);
+        std::atomic_thread_fence(std::memory_order_release);
+        h[0] = HEADER_MAGIC;
+    }
+
+    /**
+     * Follow PLC restarts from Sync, the checks that run every call stay inline
+     * In place: the PLC re-initialized the segment we map (new Generation
+     * or layout). Recreated: the name now refers to a new segment while ours
+     * went stale, probed every 16th Sync while LifePLC stands still.
+     */
+    void watchSegment() {
+        const volatile uint32_t* h = header(pData);
+        if (h[2] != generation || h[1] != layoutHash) {
+            headerChanged();
+        } else if (!transport && !owner && (++syncCount & 15) == 0) {
+            heartbeatCheck();
+        }
+    }
+
+    void headerChanged() {
+        if (header(pData)[0] != HEADER_MAGIC) return;     // PLC still initializing
+        uint32_t previous = generation;
+        if (!acceptHeader(pData)) {
+            Disconnect();
+            status = LAYOUT_MISMATCH;
+            return;
+        }
+        if (previous != 0) nextEpoch();     // Not for the first header arriving over UDP
+    }
+
+    void nextEpoch() {
+        if (++epoch == 0) epoch = 1;
+    }
+
+    void heartbeatCheck() {
+        int32_t life = *pLifePLC;
+        if (life != watchedLife) {
+            watchedLife = life;
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastProbe < std::chrono::milliseconds(20)) return;
+        lastProbe = now;
+        remap();
+    }
+
+    void remap() {
+        MapHandle handle;
+        void* data = nullptr;
+        if (!openSegment(segmentName.c_str(), handle, data)) {
+            if (status == LAYOUT_MISMATCH) {
+                Disconnect();
+                status = LAYOUT_MISMATCH;
+            }
+            return;
+        }
+
+        bool recreated = header(data)[2] != generation;
+#ifndef _WIN32
+        dev_t dev = segmentDev;
+        ino_t ino = segmentIno;
+        segmentIdentity(handle, dev, ino);
+        recreated = recreated || dev != segmentDev || ino != segmentIno;
+#endif
+        if (!recreated) {
+            closeSegment(handle, data);
+            return;
+        }
+
+        uint32_t previous = generation;
+        Status previousStatus = status;
+        if (!acceptHeader(data)) {
+            closeSegment(handle, data);
+            generation = previous;
+            if (status == LAYOUT_MISMATCH) {
+                Disconnect();
+                status = LAYOUT_MISMATCH;
+            } else {
+                status = previousStatus;    // New segment not initialized yet, keep the old mapping
+            }
+            return;
+        }
+
+        closeSegment(hMapFile, pData);
+        hMapFile = handle;
+        pData = data;
+#ifndef _WIN32
+        segmentDev = dev;
+        segmentIno = ino;
+#endif
+        bindHeartbeats(static_cast<char*>(pData));
+        lastLifePLC = 0;
+        syncCount = 0;
+        nextEpoch();
+        status = CONNECTED;
+    }
+
+    bool connectUdp(const std::string& uri) {
+        UdpTransport::Config cfg;
+        if (!UdpTransport::ParseUri(uri, cfg)) return false;
+
+        localImage.assign(dataSize, 0);
+        std::unique_ptr<UdpTransport> udp(new UdpTransport());
+        if (!udp->Open(cfg,
+                       UdpTransport::RangesFor(UdpTransport::ROLE_CPP, fromCPPOffset, lifePLCOffset),
+                       UdpTransport::RangesFor(UdpTransport::ROLE_PLC, fromCPPOffset, lifePLCOffset))) {
+            return false;
+        }
+        transport = std::move(udp);
+
+        pData = localImage.data();
+        bindHeartbeats(localImage.data());
+
+        // Announce ourselves and pick up the first PLC frame if already there;
+        // the header arrives with the PLC frames and is checked from Sync
+        transport->Send(pData);
+        transport->Receive(pData);
+
+        nextEpoch();
+        status = CONNECTED;
+        connected = true;
+        return true;
+    }
 };
 
 /**
  * Type-Safe Wrapper for Shared Memory
- * 
+ *
  * Template class that provides compile-time type safety
  * while using the generic library underneath.
  */
+template<typename TStruct, typename = void>
+struct HasSegmentHeader : std::false_type {};
+
+template<typename TStruct>
+struct HasSegmentHeader<TStruct, decltype(void(TStruct::LayoutHash))> : std::true_type {};
+
 template<typename TStruct>
 class TypedSharedMemory : public GenericSharedMemory {
 public:
@@ -126,9 +686,26 @@ public:
      * Connect using the structure's size automatically
      */
     bool Connect(const wchar_t* name) {
+        describe(HasSegmentHeader<TStruct>());
         return GenericSharedMemory::Connect(name, sizeof(TStruct));
     }
 
+    /**
+     * Create the segment as its owner (virtual PLC, benchmarks)
+     */
+    bool Create(const wchar_t* name) {
+        describe(HasSegmentHeader<TStruct>());
+        return GenericSharedMemory::Create(name, sizeof(TStruct));
+    }
+
+    /**
+     * Write through another client's mapping (see GenericSharedMemory::Share)
+     */
+    bool Share(const GenericSharedMemory& mapping) {
+        describe(HasSegmentHeader<TStruct>());
+        return GenericSharedMemory::Share(mapping, sizeof(TStruct));
+    }
+
     /**
      * Get typed pointer to data
      */
@@ -146,4 +723,64 @@ public:
     TStruct& operator*() const {
         return *GetData();
     }
+
+    /**
+     * Segment state for fast episode resets
+     * Holds the whole segment (header, ToCPP, FromCPP, heartbeats and any
+     * handshake blocks); allocate it once, it is as large as the segment.
+     */
+    struct Checkpoint {
+        TStruct image;
+        bool valid = false;
+    };
+
+    /**
+     * Copy the segment into 'checkpoint'
+     * @return false if not connected, or if LifePLC kept changing during the
+     *         copy; the checkpoint is then left invalid
+     */
+    bool SaveCheckpoint(Checkpoint& checkpoint) const {
+        const TStruct* data = GetData();
+        checkpoint.valid = false;
+        if (!IsConnected() || !data) return false;
+        const volatile int32_t* life = &data->LifePLC;
+        for (int attempt = 0; attempt < 8; attempt++) {
+            int32_t before = *life;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::memcpy(static_cast<void*>(&checkpoint.image), data, sizeof(TStruct));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (*life == before) {
+                checkpoint.valid = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Write FromCPP of 'checkpoint' back
+     * Only the C++-owned block: ToCPP belongs to the PLC and is never written
+     * from this side. Header, heartbeats and handshake blocks stay live: the
+     * segment keeps its generation, and LifeCPP advances so the PLC sees the
+     * reset as activity rather than a stall.
+     */
+    bool RestoreCheckpoint(const Checkpoint& checkpoint) {
+        TStruct* data = GetData();
+        if (!IsConnected() || !data || !checkpoint.valid) return false;
+        std::memcpy(static_cast<void*>(&data->FromCPP), &checkpoint.image.FromCPP, sizeof(data->FromCPP));
+        std::atomic_thread_fence(std::memory_order_release);
+        Sync();
+        return true;
+    }
+
+private:
+    // Structures generated before the segment header have no LayoutHash
+    void describe(std::true_type) {
+        SetLayout(offsetof(TStruct, FromCPP), offsetof(TStruct, LifePLC));
+        SetHeader(TStruct::LayoutHash);
+    }
+
+    void describe(std::false_type) {
+        SetLayout(offsetof(TStruct, FromCPP), offsetof(TStruct, LifePLC));
+    }
 };
@@ -0,0 +1,105 @@
+#pragma once
+
+// Futex on Linux; Windows has no cross-process wait on an address, so it spins and yields
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #include <sched.h>
+  #include <cerrno>
+  #include <climits>
+  #include <ctime>
+#else
+  #include <sched.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Lockstep Handshake
+ *
+ * Counters in ST_Lockstep (shared segment) that let the PLC and the Webots
+ * controller take turns instead of free-running:
+ *
+ *   Enable   C++  1 while the controller runs in lockstep, the PLC free-runs on 0
+ *   StepMs   C++  Simulated time per step (the PLC advances its clock by it)
+ *   PlcDone  PLC  Cycles completed; a cycle starts once SimDone == PlcDone
+ *   SimDone  C++  Steps completed; a step starts once PlcDone == SimDone + 1
+ *
+ * Both sides publish with Publish() (release store + wake) and block in
+ * WaitUntil(), so a run proceeds as fast as both compute, independent of
+ * wall-clock time. The generated layouts keep ST_Lockstep 4 byte aligned,
+ * which the futex requires.
+ */
+
+namespace Lockstep {
+
+inline int32_t Load(const volatile int32_t* word) {
+    int32_t value = *word;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return value;
+}
+
+inline void Wake(volatile int32_t* word) {
+#if defined(__linux__)
+    // Shared mapping: no FUTEX_PRIVATE_FLAG
+    syscall(SYS_futex, const_cast<int32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+/**
+ * Store a counter and wake the peer
+ */
+inline void Publish(volatile int32_t* word, int32_t value) {
+    std::atomic_thread_fence(std::memory_order_release);
+    *word = value;
+    Wake(word);
+}
+
+/**
+ * Block until *word == value
+ * Spins briefly (the peer is often mid-cycle), then sleeps in the kernel.
+ * @return false after timeoutMs without a match
+ */
+inline bool WaitUntil(const volatile int32_t* word, int32_t value, int timeoutMs) {
+    for (int spin = 0; spin < 2000; spin++) {
+        if (Load(word) == value) return true;
+#if defined(_WIN32)
+        YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        int32_t current = Load(word);
+        if (current == value) return true;
+        auto left = deadline - std::chrono::steady_clock::now();
+        if (left <= std::chrono::steady_clock::duration::zero()) return false;
+#if defined(__linux__)
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        if (syscall(SYS_futex, const_cast<int32_t*>(word), FUTEX_WAIT, current, &ts, nullptr, 0) != 0 && errno == EINVAL) {
+            sched_yield();      // Misaligned word (segment from an older generator)
+        }
+#elif defined(_WIN32)
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+}
+
+} // namespace Lockstep
@@ -7,7 +7,7 @@
 #include <stdexcept>
 
 // Minimal JSON parser for code generator (no external dependencies)
-// Supports: objects, arrays, strings, numbers
+// Supports: objects, arrays, strings, numbers, booleans, null
 
 class SimpleJSON {
 public:
@@ -36,6 +36,24 @@ public:
         return (it != object.end() && it->second.type == ARRAY) ? it->second.array : empty;
     }
 
+    const SimpleJSON* getObject(const std::string& key) const {
+        auto it = object.find(key);
+        return (it != object.end() && it->second.type == OBJECT) ? &it->second : nullptr;
+    }
+
+    double getDouble(const std::string& key, double def = 0.0) const {
+        auto it = object.find(key);
+        if (it != object.end() && it->second.type == NUMBER) {
+            return std::stod(it->second.value);
+        }
+        return def;
+    }
+
+    bool getBool(const std::string& key, bool def = false) const {
+        auto it = object.find(key);
+        return (it != object.end() && it->second.type == BOOLEAN) ? it->second.value == "true" : def;
+    }
+
     int getInt(const std::string& key, int def = 0) const {
         auto it = object.find(key);
         if (it != object.end() && it->second.type == NUMBER) {
@@ -55,6 +73,7 @@ private:
         if (c == '[') return parseArray(json, pos);
         if (c == '"') return parseString(json, pos);
         if (c == '-' || isdigit(c)) return parseNumber(json, pos);
+        if (c == 't' || c == 'f' || c == 'n') return parseLiteral(json, pos);
         throw std::runtime_error(std::string("Unexpected character: ") + c);
     }
 
@@ -72,8 +91,7 @@ private:
             if (json[pos] != ':') throw std::runtime_error("Expected ':'");
             pos++;
             
-            auto val = parseValue(json, pos);
-            obj.object[key.value] = val;
+            obj.object[key.value] = parseValue(json, pos);
             
             skipWhitespace(json, pos);
             if (json[pos] == ',') pos++;
@@ -105,8 +123,14 @@ private:
         str.type = STRING;
         pos++; // skip opening '"'
         
-        while (json[pos] != '"') {
-            if (json[pos] == '\\') pos++; // skip escape
+        while (true) {
+            size_t stop = json.find_first_of("\"\\", pos);
+            if (stop == std::string::npos) throw std::runtime_error("Unterminated string");
+            str.value.append(json, pos, stop - pos);
+            pos = stop;
+            if (json[pos] == '"') break;
+            pos++; // skip escape
+            if (pos >= json.size()) throw std::runtime_error("Unterminated string");
             str.value += json[pos++];
         }
         pos++; // skip closing '"'
@@ -117,12 +141,23 @@ private:
         SimpleJSON num;
         num.type = NUMBER;
         
-        while (pos < json.size() && (isdigit(json[pos]) || json[pos] == '.' || json[pos] == '-' || json[pos] == 'e' || json[pos] == 'E')) {
-            num.value += json[pos++];
+        size_t start = pos;
+        while (pos < json.size() && (isdigit(json[pos]) || json[pos] == '.' || json[pos] == '-' || json[pos] == '+' || json[pos] == 'e' || json[pos] == 'E')) {
+            pos++;
         }
+        num.value.assign(json, start, pos - start);
         return num;
     }
 
+    static SimpleJSON parseLiteral(const std::string& json, size_t& pos) {
+        SimpleJSON lit;
+        if (json.compare(pos, 4, "true") == 0) { lit.type = BOOLEAN; lit.value = "true"; pos += 4; }
+        else if (json.compare(pos, 5, "false") == 0) { lit.type = BOOLEAN; lit.value = "false"; pos += 5; }
+        else if (json.compare(pos, 4, "null") == 0) { lit.type = NULL_TYPE; pos += 4; }
+        else throw std::runtime_error("Unexpected literal at position " + std::to_string(pos));
+        return lit;
+    }
+
     static void skipWhitespace(const std::string& json, size_t& pos) {
         while (pos < json.size() && isspace(json[pos])) pos++;
     }
@@ -0,0 +1,654 @@
+#pragma once
+
+// Socket API for the network transport
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#else
+  #include <arpa/inet.h>
+  #include <netdb.h>
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <cerrno>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * UDP Transport for Split-Host Deployments
+ *
+ * Carries the shared memory image between two hosts (PLC host <-> simulation
+ * host) as compact binary frames. Each side transmits only the byte ranges it
+ * owns and receives the ranges owned by the peer:
+ *
+ *   PLC side: ToCPP + LifePLC     C++ side: FromCPP + LifeCPP
+ *
+ * Frames carry a sequence number (loss detection), the last frame applied
+ * from the peer (ack) and optionally a delta against that acknowledged frame.
+ * Every Open draws a new session id; a peer that restarts (and counts from
+ * seq 1 again) is recognized by it, and the receive state and delta history
+ * start over instead of dropping its frames as stale.
+ * Frames larger than one datagram are fragmented and sent as one batch
+ * (sendmmsg/recvmmsg on Linux, a send/recv loop elsewhere).
+ *
+ * Both peers are expected to share the same byte order (x86/x64 and ARM
+ * little-endian targets).
+ *
+ * URI format: udp://<remote-host>:<remote-port>[?bind=<local-port>&delta=0|1&mtu=<bytes>]
+ */
+
+struct UdpRange {
+    uint32_t offset;
+    uint32_t size;
+};
+
+#pragma pack(push, 1)
+struct UdpFrameHeader {
+    uint32_t magic;          // UdpTransport::MAGIC
+    uint32_t session;        // Sender's session, new on every Open
+    uint32_t ackSession;     // Receiver session 'ack' refers to, 0 = none yet
+    uint32_t seq;            // Frame sequence number (starts at 1)
+    uint32_t baseSeq;        // Delta base frame, 0 = full frame
+    uint32_t ack;            // Last frame fully applied from the peer
+    uint32_t imageSize;      // Transmitted image size (layout guard)
+    uint32_t payloadSize;    // Encoded payload size of the whole frame
+    uint32_t fragOffset;     // Offset of this fragment inside the payload
+    uint16_t fragIndex;
+    uint16_t fragCount;
+};
+#pragma pack(pop)
+
+class UdpTransport {
+public:
+    static const uint32_t MAGIC = 0x31425743;   // "CWB1"
+    static const size_t HISTORY = 8;            // Frames kept for delta baselines
+
+    enum Role { ROLE_PLC, ROLE_CPP };
+
+    struct Config {
+        std::string remoteHost;
+        uint16_t remotePort;
+        uint16_t localPort;
+        bool delta;
+        size_t mtu;
+
+        Config() : remotePort(0), localPort(0), delta(true), mtu(1400) {}
+    };
+
+    struct Stats {
+        uint64_t framesSent;
+        uint64_t framesReceived;
+        uint64_t framesLost;
+        uint64_t framesDropped;     // Out of order, stale or undecodable
+        uint64_t deltaFrames;
+        uint64_t fullFrames;
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+        uint64_t peerRestarts;      // Session changes of the peer
+
+        Stats() : framesSent(0), framesReceived(0), framesLost(0), framesDropped(0),
+                  deltaFrames(0), fullFrames(0), bytesSent(0), bytesReceived(0), peerRestarts(0) {}
+    };
+
+private:
+    struct Snapshot {
+        uint32_t seq;
+        std::vector<uint8_t> image;
+        Snapshot() : seq(0) {}
+    };
+
+#ifdef _WIN32
+    typedef SOCKET socket_t;
+    static socket_t invalidSocket() { return INVALID_SOCKET; }
+#else
+    typedef int socket_t;
+    static socket_t invalidSocket() { return -1; }
+#endif
+
+    Config config;
+    socket_t sock;
+    sockaddr_in remoteAddr;
+    bool open;
+
+    std::vector<UdpRange> txRanges, rxRanges;
+    size_t txSize, rxSize;
+
+    // Transmit side
+    uint32_t session;                   // Ours, drawn in Open
+    uint32_t txSeq;
+    std::vector<uint8_t> txImage;
+    std::vector<uint8_t> txPayload;
+    Snapshot txHistory[HISTORY];
+
+    // Receive side
+    uint32_t peerSession;               // Session of the frames in rxHistory, 0 = none yet
+    uint32_t rxApplied;                 // Last frame applied (acknowledged to the peer)
+    uint32_t peerAck;                   // Last of our frames the peer applied
+    Snapshot rxHistory[HISTORY];
+    std::vector<uint8_t> rxPayload;
+    std::vector<uint8_t> rxFragSeen;
+    uint32_t rxPendingSeq, rxPendingBase;
+    uint16_t rxPendingFrags, rxPendingCount;
+    std::vector<uint8_t> datagram;
+
+#if defined(__linux__)
+    // sendmmsg/recvmmsg batches, sized once in Open so Send/Receive do not allocate
+    static constexpr size_t TX_BATCH = 64;
+    static constexpr size_t RX_BATCH = 32;
+    UdpFrameHeader txHeaders[TX_BATCH];
+    mmsghdr txMsgs[TX_BATCH];
+    iovec txIov[TX_BATCH][2];
+    std::vector<uint8_t> rxBuffers;
+    mmsghdr rxMsgs[RX_BATCH];
+    iovec rxIov[RX_BATCH];
+#endif
+
+    Stats stats;
+
+public:
+    UdpTransport()
+        : sock(invalidSocket()), open(false), txSize(0), rxSize(0), session(0), txSeq(0),
+          peerSession(0), rxApplied(0), peerAck(0), rxPendingSeq(0), rxPendingBase(0),
+          rxPendingFrags(0), rxPendingCount(0) {
+        std::memset(&remoteAddr, 0, sizeof(remoteAddr));
+    }
+
+    ~UdpTransport() {
+        Close();
+    }
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    /**
+     * Parse a transport URI
+     * @param uri e.g. "udp://10.0.0.5:47000?bind=47001"
+     * @return false if the URI is not a valid udp:// URI
+     */
+    static bool ParseUri(const std::string& uri, Config& cfg) {
+        const std::string scheme = "udp://";
+        if (uri.compare(0, scheme.size(), scheme) != 0) return false;
+
+        std::string rest = uri.substr(scheme.size());
+        std::string query;
+        size_t q = rest.find('?');
+        if (q != std::string::npos) {
+            query = rest.substr(q + 1);
+            rest = rest.substr(0, q);
+        }
+
+        size_t colon = rest.rfind(':');
+        if (colon == std::string::npos || colon == 0) return false;
+        cfg.remoteHost = rest.substr(0, colon);
+        cfg.remotePort = static_cast<uint16_t>(std::atoi(rest.c_str() + colon + 1));
+        cfg.localPort = cfg.remotePort;
+        if (cfg.remotePort == 0) return false;
+
+        size_t pos = 0;
+        while (pos < query.size()) {
+            size_t amp = query.find('&', pos);
+            if (amp == std::string::npos) amp = query.size();
+            std::string item = query.substr(pos, amp - pos);
+            size_t eq = item.find('=');
+            if (eq != std::string::npos) {
+                std::string key = item.substr(0, eq);
+                int value = std::atoi(item.c_str() + eq + 1);
+                if (key == "bind") cfg.localPort = static_cast<uint16_t>(value);
+                else if (key == "delta") cfg.delta = (value != 0);
+                else if (key == "mtu" && value > 256) cfg.mtu = static_cast<size_t>(value);
+            }
+            pos = amp + 1;
+        }
+        return true;
+    }
+
+    /**
+     * Byte ranges transmitted by one side of the bridge
+     * @param role Which side is sending
+     * @param fromCPPOffset Offset of the FromCPP block inside the structure
+     * @param lifePLCOffset Offset of LifePLC (LifeCPP follows it)
+     */
+    static std::vector<UdpRange> RangesFor(Role role, size_t fromCPPOffset, size_t lifePLCOffset) {
+        std::vector<UdpRange> ranges;
+        uint32_t split = static_cast<uint32_t>(fromCPPOffset);
+        uint32_t life = static_cast<uint32_t>(lifePLCOffset);
+        if (role == ROLE_PLC) {
+            if (split > 0) ranges.push_back({0, split});
+            ranges.push_back({life, 4});
+        } else {
+            if (life > split) ranges.push_back({split, life - split});
+            ranges.push_back({life + 4, 4});
+        }
+        return ranges;
+    }
+
+    /**
+     * Open the socket
+     * @param tx Ranges of the local image this side transmits
+     * @param rx Ranges of the local image the peer transmits
+     */
+    bool Open(const Config& cfg, const std::vector<UdpRange>& tx, const std::vector<UdpRange>& rx) {
+        Close();
+        config = cfg;
+        txRanges = tx;
+        rxRanges = rx;
+        txSize = totalSize(txRanges);
+        rxSize = totalSize(rxRanges);
+
+#ifdef _WIN32
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+
+        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock == invalidSocket()) return false;
+
+        sockaddr_in local;
+        std::memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_ANY);
+        local.sin_port = htons(config.localPort);
+        if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            Close();
+            return false;
+        }
+
+        if (!resolve(config.remoteHost, config.remotePort, remoteAddr)) {
+            Close();
+            return false;
+        }
+
+#ifdef _WIN32
+        u_long nonBlocking = 1;
+        ioctlsocket(sock, FIONBIO, &nonBlocking);
+#else
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+        int bufferSize = 4 * 1024 * 1024;
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+        setsockopt(sock, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+        txImage.assign(txSize, 0);
+        for (size_t i = 0; i < HISTORY; i++) {
+            txHistory[i].seq = 0;
+            txHistory[i].image.assign(txSize, 0);
+            rxHistory[i].seq = 0;
+            rxHistory[i].image.assign(rxSize, 0);
+        }
+        datagram.resize(config.mtu);
+#if defined(__linux__)
+        rxBuffers.assign(RX_BATCH * config.mtu, 0);
+        for (size_t k = 0; k < RX_BATCH; k++) {
+            rxIov[k].iov_base = &rxBuffers[k * config.mtu];
+            rxIov[k].iov_len = config.mtu;
+            std::memset(&rxMsgs[k], 0, sizeof(rxMsgs[k]));
+            rxMsgs[k].msg_hdr.msg_iov = &rxIov[k];
+            rxMsgs[k].msg_hdr.msg_iovlen = 1;
+        }
+        for (size_t k = 0; k < TX_BATCH; k++) {
+            std::memset(&txMsgs[k], 0, sizeof(txMsgs[k]));
+            txIov[k][0].iov_base = &txHeaders[k];
+            txIov[k][0].iov_len = sizeof(UdpFrameHeader);
+            txMsgs[k].msg_hdr.msg_name = &remoteAddr;
+            txMsgs[k].msg_hdr.msg_namelen = sizeof(remoteAddr);
+            txMsgs[k].msg_hdr.msg_iov = txIov[k];
+            txMsgs[k].msg_hdr.msg_iovlen = 2;
+        }
+#endif
+        session = newSession();
+        txSeq = 0;
+        peerSession = 0;
+        rxApplied = 0;
+        peerAck = 0;
+        rxPendingSeq = 0;
+        stats = Stats();
+        open = true;
+        return true;
+    }
+
+    void Close() {
+        if (sock != invalidSocket()) {
+#ifdef _WIN32
+            closesocket(sock);
+            WSACleanup();
+#else
+            close(sock);
+#endif
+            sock = invalidSocket();
+        }
+        open = false;
+    }
+
+    bool IsOpen() const {
+        return open;
+    }
+
+    const Stats& GetStats() const {
+        return stats;
+    }
+
+    /**
+     * Transmit the owned ranges of the image as one frame
+     * @param image Local copy of the whole structure
+     */
+    bool Send(const void* image) {
+        if (!open) return false;
+
+        gather(static_cast<const uint8_t*>(image), txRanges, txImage.data());
+
+        uint32_t seq = ++txSeq;
+        if (seq == 0) seq = ++txSeq;
+
+        // Delta against the last frame the peer acknowledged, if still in history
+        uint32_t baseSeq = 0;
+        const Snapshot& base = txHistory[peerAck % HISTORY];
+        if (config.delta && peerAck != 0 && base.seq == peerAck) {
+            encodeDelta(base.image.data(), txImage.data(), txSize, txPayload);
+            if (txPayload.size() < txSize) baseSeq = peerAck;
+        }
+        if (baseSeq == 0) {
+            txPayload.assign(txImage.begin(), txImage.end());
+            stats.fullFrames++;
+        } else {
+            stats.deltaFrames++;
+        }
+
+        Snapshot& slot = txHistory[seq % HISTORY];
+        slot.seq = seq;
+        slot.image.assign(txImage.begin(), txImage.end());
+
+        UdpFrameHeader hdr;
+        hdr.magic = MAGIC;
+        hdr.session = session;
+        hdr.ackSession = peerSession;
+        hdr.seq = seq;
+        hdr.baseSeq = baseSeq;
+        hdr.ack = rxApplied;
+        hdr.imageSize = static_cast<uint32_t>(txSize);
+        hdr.payloadSize = static_cast<uint32_t>(txPayload.size());
+
+        size_t chunk = config.mtu - sizeof(UdpFrameHeader);
+        size_t fragCount = txPayload.empty() ? 1 : (txPayload.size() + chunk - 1) / chunk;
+        if (fragCount > 0xFFFF) return false;
+        hdr.fragCount = static_cast<uint16_t>(fragCount);
+
+        stats.framesSent++;
+        return sendFragments(hdr, chunk, fragCount);
+    }
+
+    /**
+     * Drain pending datagrams and apply every completed frame
+     * @param image Local copy of the whole structure (peer ranges are written)
+     * @return Number of frames applied
+     */
+    int Receive(void* image) {
+        if (!open) return 0;
+
+        int applied = 0;
+        receiveBatch([&](const uint8_t* data, size_t len) {
+            if (handleDatagram(data, len)) {
+                scatter(rxHistory[rxApplied % HISTORY].image.data(), rxRanges, static_cast<uint8_t*>(image));
+                applied++;
+            }
+        });
+        return applied;
+    }
+
+private:
+    static uint32_t newSession() {
+        std::random_device rd;
+        uint32_t id = rd() ^ static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        return id ? id : 1;
+    }
+
+    // The peer reopened: its sequence numbers and acks start over
+    void peerRestarted(uint32_t newSessionId) {
+        if (peerSession != 0) stats.peerRestarts++;
+        peerSession = newSessionId;
+        rxApplied = 0;
+        peerAck = 0;
+        rxPendingSeq = 0;
+        for (size_t i = 0; i < HISTORY; i++) rxHistory[i].seq = 0;
+    }
+
+    static size_t totalSize(const std::vector<UdpRange>& ranges) {
+        size_t total = 0;
+        for (const auto& r : ranges) total += r.size;
+        return total;
+    }
+
+    static void gather(const uint8_t* src, const std::vector<UdpRange>& ranges, uint8_t* dst) {
+        for (const auto& r : ranges) {
+            std::memcpy(dst, src + r.offset, r.size);
+            dst += r.size;
+        }
+    }
+
+    static void scatter(const uint8_t* src, const std::vector<UdpRange>& ranges, uint8_t* dst) {
+        for (const auto& r : ranges) {
+            std::memcpy(dst + r.offset, src, r.size);
+            src += r.size;
+        }
+    }
+
+    static bool resolve(const std::string& host, uint16_t port, sockaddr_in& addr) {
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) return false;
+        std::memcpy(&addr, result->ai_addr, sizeof(addr));
+        addr.sin_port = htons(port);
+        freeaddrinfo(result);
+        return true;
+    }
+
+    /**
+     * Delta payload: sequence of runs [uint32 offset][uint16 length][bytes]
+     * Runs separated by fewer than 8 unchanged bytes are merged.
+     */
+    static void encodeDelta(const uint8_t* base, const uint8_t* cur, size_t size, std::vector<uint8_t>& out) {
+        out.clear();
+        size_t i = 0;
+        while (i < size) {
+            // Skip unchanged bytes a word at a time
+            while (i + 8 <= size && std::memcmp(base + i, cur + i, 8) == 0) i += 8;
+            while (i < size && base[i] == cur[i]) i++;
+            if (i >= size) break;
+
+            size_t start = i;
+            size_t end = i + 1;
+            size_t same = 0;
+            while (end < size && end - start < 0xFFFF) {
+                if (base[end] == cur[end]) {
+                    if (++same >= 8) { end++; break; }
+                } else {
+                    same = 0;
+                }
+                end++;
+            }
+            end -= same;
+
+            uint32_t off = static_cast<uint32_t>(start);
+            uint16_t len = static_cast<uint16_t>(end - start);
+            size_t pos = out.size();
+            out.resize(pos + 6 + len);
+            std::memcpy(&out[pos], &off, 4);
+            std::memcpy(&out[pos + 4], &len, 2);
+            std::memcpy(&out[pos + 6], cur + start, len);
+            if (out.size() >= size) return;   // Not worth it, caller sends a full frame
+            i = end;
+        }
+    }
+
+    static bool applyDelta(const uint8_t* payload, size_t len, uint8_t* image, size_t size) {
+        size_t pos = 0;
+        while (pos + 6 <= len) {
+            uint32_t off;
+            uint16_t runLen;
+            std::memcpy(&off, payload + pos, 4);
+            std::memcpy(&runLen, payload + pos + 4, 2);
+            pos += 6;
+            if (pos + runLen > len || off + runLen > size) return false;
+            std::memcpy(image + off, payload + pos, runLen);
+            pos += runLen;
+        }
+        return pos == len;
+    }
+
+    bool sendFragments(UdpFrameHeader& hdr, size_t chunk, size_t fragCount) {
+#if defined(__linux__)
+        for (size_t first = 0; first < fragCount; first += TX_BATCH) {
+            size_t n = std::min(TX_BATCH, fragCount - first);
+            for (size_t k = 0; k < n; k++) {
+                size_t frag = first + k;
+                size_t off = frag * chunk;
+                size_t len = std::min(chunk, txPayload.size() - std::min(off, txPayload.size()));
+                hdr.fragIndex = static_cast<uint16_t>(frag);
+                hdr.fragOffset = static_cast<uint32_t>(off);
+                txHeaders[k] = hdr;
+                txIov[k][1].iov_base = len ? &txPayload[off] : nullptr;
+                txIov[k][1].iov_len = len;
+                stats.bytesSent += sizeof(UdpFrameHeader) + len;
+            }
+            size_t done = 0;
+            while (done < n) {
+                int sent = sendmmsg(sock, txMsgs + done, static_cast<unsigned>(n - done), 0);
+                if (sent <= 0) return false;
+                done += static_cast<size_t>(sent);
+            }
+        }
+        return true;
+#else
+        for (size_t frag = 0; frag < fragCount; frag++) {
+            size_t off = frag * chunk;
+            size_t len = std::min(chunk, txPayload.size() - std::min(off, txPayload.size()));
+            hdr.fragIndex = static_cast<uint16_t>(frag);
+            hdr.fragOffset = static_cast<uint32_t>(off);
+            std::memcpy(datagram.data(), &hdr, sizeof(hdr));
+            if (len) std::memcpy(datagram.data() + sizeof(hdr), &txPayload[off], len);
+
+            int total = static_cast<int>(sizeof(hdr) + len);
+            if (sendto(sock, reinterpret_cast<const char*>(datagram.data()), total, 0,
+                       reinterpret_cast<const sockaddr*>(&remoteAddr), sizeof(remoteAddr)) != total) {
+                return false;
+            }
+            stats.bytesSent += static_cast<uint64_t>(total);
+        }
+        return true;
+#endif
+    }
+
+    template<typename Handler>
+    void receiveBatch(Handler handler) {
+#if defined(__linux__)
+        while (true) {
+            int n = recvmmsg(sock, rxMsgs, RX_BATCH, MSG_DONTWAIT, nullptr);
+            if (n <= 0) break;
+            for (int k = 0; k < n; k++) {
+                stats.bytesReceived += rxMsgs[k].msg_len;
+                handler(&rxBuffers[k * config.mtu], rxMsgs[k].msg_len);
+            }
+            if (n < static_cast<int>(RX_BATCH)) break;
+        }
+#else
+        while (true) {
+            int n = recvfrom(sock, reinterpret_cast<char*>(datagram.data()),
+                             static_cast<int>(datagram.size()), 0, nullptr, nullptr);
+            if (n <= 0) break;
+            stats.bytesReceived += static_cast<uint64_t>(n);
+            handler(datagram.data(), static_cast<size_t>(n));
+        }
+#endif
+    }
+
+    /**
+     * Reassemble fragments; decode and commit the frame once complete
+     * @return true if a new frame was committed to the receive history
+     */
+    bool handleDatagram(const uint8_t* data, size_t len) {
+        if (len < sizeof(UdpFrameHeader)) return false;
+        UdpFrameHeader hdr;
+        std::memcpy(&hdr, data, sizeof(hdr));
+        if (hdr.magic != MAGIC || hdr.imageSize != rxSize || hdr.fragCount == 0) {
+            stats.framesDropped++;
+            return false;
+        }
+
+        if (hdr.session != peerSession) peerRestarted(hdr.session);
+        // Acks sent before the peer saw this session refer to frames of an earlier Open
+        if (hdr.ackSession == session && seqNewer(hdr.ack, peerAck)) peerAck = hdr.ack;
+        if (rxApplied != 0 && !seqNewer(hdr.seq, rxApplied)) {   // Stale, counted once per frame
+            if (hdr.fragIndex == 0) stats.framesDropped++;
+            return false;
+        }
+
+        if (hdr.seq != rxPendingSeq) {
+            if (rxPendingSeq != 0 && seqNewer(rxPendingSeq, rxApplied)) {
+                if (!seqNewer(hdr.seq, rxPendingSeq)) {                // Older than the frame in progress
+                    if (hdr.fragIndex == 0) stats.framesDropped++;
+                    return false;
+                }
+                stats.framesDropped++;                                 // Superseded before completion
+            }
+            rxPendingSeq = hdr.seq;
+            rxPendingBase = hdr.baseSeq;
+            rxPendingCount = hdr.fragCount;
+            rxPendingFrags = 0;
+            rxPayload.resize(hdr.payloadSize);
+            rxFragSeen.assign(hdr.fragCount, 0);
+        }
+
+        size_t chunkLen = len - sizeof(UdpFrameHeader);
+        if (hdr.fragIndex >= rxPendingCount || rxFragSeen[hdr.fragIndex] ||
+            hdr.fragOffset + chunkLen > rxPayload.size()) {
+            return false;
+        }
+        if (chunkLen) std::memcpy(&rxPayload[hdr.fragOffset], data + sizeof(UdpFrameHeader), chunkLen);
+        rxFragSeen[hdr.fragIndex] = 1;
+        if (++rxPendingFrags < rxPendingCount) return false;
+
+        // Frame complete
+        uint32_t seq = rxPendingSeq;
+        rxPendingSeq = 0;
+        Snapshot& slot = rxHistory[seq % HISTORY];
+        if (rxPendingBase == 0) {
+            if (rxPayload.size() != rxSize) { stats.framesDropped++; return false; }
+            slot.image.assign(rxPayload.begin(), rxPayload.end());
+        } else {
+            const Snapshot& base = rxHistory[rxPendingBase % HISTORY];
+            if (base.seq != rxPendingBase) { stats.framesDropped++; return false; }
+            if (&slot != &base) slot.image = base.image;
+            if (!applyDelta(rxPayload.data(), rxPayload.size(), slot.image.data(), rxSize)) {
+                slot.seq = 0;
+                stats.framesDropped++;
+                return false;
+            }
+        }
+        slot.seq = seq;
+
+        if (rxApplied != 0 && seq - rxApplied > 1) stats.framesLost += seq - rxApplied - 1;
+        rxApplied = seq;
+        stats.framesReceived++;
+        return true;
+    }
+
+    static bool seqNewer(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) > 0;
+    }
+};
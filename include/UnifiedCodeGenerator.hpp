@@ -5,12 +5,20 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <ctime>
 #include <iomanip>
 #include <random>
+#include <set>
+#include <type_traits>
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/stat.h>
 #endif
 
 /**
@@ -22,8 +30,56 @@
  * 3. C++ typed client  
  * 4. Webots controller
  * 5. Usage README
+ * 6. UDP relay (PLC host side of split-host deployments)
+ * 7. Layout report (when "optimizeLayout" is enabled)
+ * 8. Client microbenchmark (optional)
+ * 9. Virtual PLC for load tests without CODESYS (optional)
+ * 10. C ABI library source (lib<name>bridge for non-C++ tooling)
  */
 
+/**
+ * Generated file assembled in memory and written with a single call
+ * (large schemas produce millions of small fragments per file)
+ */
+class OutputBuffer {
+private:
+    std::string path;
+    std::string text;
+
+public:
+    explicit OutputBuffer(const std::string& outputPath, size_t reserve = 4096) : path(outputPath) {
+        text.reserve(reserve);
+    }
+
+    ~OutputBuffer() {
+        std::ofstream file(path, std::ios::out);
+        if (!file.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            std::cerr << "Warning: Could not write " << path << std::endl;
+        }
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    OutputBuffer& operator<<(const char* s) { text.append(s); return *this; }
+    OutputBuffer& operator<<(const std::string& s) { text.append(s); return *this; }
+    OutputBuffer& operator<<(char c) { text.push_back(c); return *this; }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value, OutputBuffer&>::type operator<<(T value) {
+        text.append(std::to_string(value));
+        return *this;
+    }
+
+    // Same formatting as the default std::ostream (%g)
+    OutputBuffer& operator<<(double value) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%g", value);
+        text.append(number);
+        return *this;
+    }
+};
+
 class UnifiedCodeGenerator {
 public:
     struct Variable {
@@ -31,27 +87,171 @@ public:
         std::string type;
         std::string direction;
         int size;
+        bool hot;       // Declared "access": "hot" - touched every cycle
+
+        // Virtual PLC stimulus (toCPP only): "sine", "step", "ramp", "random"
+        std::string waveform;
+        double amplitude, period, offset;
+
+        // Transport encoding: stored as 'encoding', engineering = raw * scale + offset
+        std::string encoding;       // Raw type in the segment, empty = stored as 'type'
+        double encodingScale, encodingOffset;
+        std::string group;          // Bulk accessor group of encoded variables
+
+        // Webots device feeding a fromCPP variable, empty = not read by the controller
+        std::string deviceType;     // PositionSensor, TouchSensor, InertialUnit, GPS, DistanceSensor, TorqueFeedback
+        std::string deviceName;
+        int devicePeriod;           // Sampling period in ms, 0 = every TIME_STEP
+        int deviceIndex;            // Component of GPS values / InertialUnit roll-pitch-yaw
+
+        // Packed BOOL group: a member bit (type BOOL) or one of the group's words (DWORD/LWORD)
+        std::string bitGroup;
+        int bitIndex;               // Bit: position in the group, word: word number
+
+        bool stats;                 // Aggregated into the statistics segment (see BridgeStats.hpp)
+
+        // Hinge joint exchanged by the physics plugin every physics step, empty = via the controller
+        std::string physicsBody;    // DEF name of the solid the joint moves
+        std::string physicsValue;   // "position" or "velocity" (setpoint or measured)
+        double physicsGain, physicsMaxVelocity, physicsMaxForce;     // Position setpoints only
+
+        std::string writer;         // Writer partition of a fromCPP variable, empty = shared ST_FromCPP
         
-        Variable() : size(0) {}
+        Variable() : size(0), hot(false), amplitude(1.0), period(2.0), offset(0.0),
+                     encodingScale(1.0), encodingOffset(0.0), devicePeriod(0), deviceIndex(0), bitIndex(0),
+                     stats(false), physicsGain(20.0), physicsMaxVelocity(3.14), physicsMaxForce(1000.0) {}
+    };
+
+    // BOOLs packed into DWORD (up to 32 bits) or LWORD words; the words are in 'variables'
+    struct BitGroup {
+        std::string name;
+        std::string direction;
+        std::string wordType;
+        size_t wordBits;
+        std::string writer;             // Writer partition of a fromCPP group
+        std::vector<Variable> bits;     // Bit i lives in word i / wordBits, bit i % wordBits
+    };
+
+    // Field placement inside the shared segment
+    struct FieldSlot {
+        std::string name;
+        std::string type;
+        std::string direction;
+        size_t offset;      // Absolute offset inside ST_<Name>
+        size_t size;
+        size_t align;
+        bool hot;
+    };
+
+    // ST_FromCPP_<Writer>: Seq, Life, then the writer's fields, on cache lines of its own
+    struct PartitionSlot {
+        std::string name;
+        size_t padding;     // Pad_<Writer> bytes in front of it
+        size_t offset;
+        size_t size;
+    };
+
+    struct SegmentLayout {
+        std::vector<FieldSlot> fields;
+        std::vector<PartitionSlot> partitions;
+        size_t toCPPOffset, toCPPSize;
+        size_t fromCPPOffset, fromCPPSize;
+        size_t lifePadding;         // Pad_Life bytes before LifePLC (4 byte or cache line boundary)
+        size_t lifePLCOffset, lifeCPPOffset;
+        size_t lockstepOffset;      // ST_Lockstep, 0 without lockstep
+        size_t totalSize;
+        size_t padding;
+    };
+
+    // ST_SegmentHeader at offset 0: Magic, LayoutHash, Generation, Size (UDINT each)
+    static const size_t SEGMENT_HEADER_SIZE = 16;
+    static const uint32_t SEGMENT_MAGIC = 0x31425743u;     // "CWB1", see GenericSharedMemory
+
+    // ST_Lockstep: Enable, StepMs, PlcDone, SimDone (DINT each)
+    static const size_t LOCKSTEP_SIZE = 16;
+
+    // Writer partitions start with Seq (UDINT) and Life (DINT) and are cache line aligned
+    static const size_t PARTITION_HEADER_SIZE = 8;
+    static const size_t CACHE_LINE = 64;
+
+    // fromCPP variables published by one writer (see "writer" in the schema)
+    struct Writer {
+        std::string name;
+        std::vector<size_t> fields;     // Indices into 'variables', in order
+    };
+
+    // Pre-indexed view of the schema shared by all emitters (see model())
+    struct Model {
+        std::string lowerName;
+        std::vector<size_t> toCPP, fromCPP;     // Indices into 'variables', in order (fromCPP: shared block)
+        std::vector<Writer> writers;            // Writer partitions, in declaration order
+        std::vector<std::string> capitalized;   // Accessor suffix per variable
+        std::map<std::string, std::vector<size_t>> groups;     // Encoding groups
+        std::vector<size_t> stats;              // Variables of ST_<Name>Stats, in order
+        std::vector<size_t> physics;            // Variables exchanged by the physics plugin
+        uint32_t statsHash = 0;
+        SegmentLayout layout;
+        uint32_t layoutHash = 0;                // Fingerprint stored in the segment header
     };
 
     std::string memoryName;
     std::vector<Variable> variables;
+    std::vector<BitGroup> bitGroups;
+    std::vector<std::string> writerNames;   // Writer partitions in declaration order
+
+    // Layout options: "packed" (pack 1, default) or "aligned" (natural alignment)
+    std::string layoutMode = "packed";
+    bool layoutOptimization = false;
+    bool lockstep = false;          // ST_Lockstep handshake after LifeCPP (see Lockstep.hpp)
+    double statsWindowMs = 1000;    // Window of the statistics segment
+    int timeStep = 0;               // Controller step in ms, 0 = the world's basicTimeStep
+
+    // Output options
+    std::string outputDir = "generated";
+    bool emitBenchmark = false;     // Client microbenchmark (<name>_bench.cpp)
+    bool emitVirtualPLC = false;    // Stand-in PLC for load tests (<name>_virtual_plc.cpp)
     
     // UUIDs for PLCopenXML
-    std::string uuidMain, uuidToCPP, uuidFromCPP;
+    std::string uuidMain, uuidToCPP, uuidFromCPP, uuidHeader, uuidLockstep, uuidGeneration;
+    std::map<std::string, std::string> uuidWriters;
+
+    // Wall time per generation stage in milliseconds (filled by loadSchema/generateAll)
+    std::vector<std::pair<std::string, double>> stageTimes;
+
+private:
+    Model indexed;
+    bool indexValid = false;
+
+public:
 
     void loadSchema(const std::string& filepath) {
+        auto start = std::chrono::steady_clock::now();
         std::ifstream file(filepath);
         if (!file) throw std::runtime_error("Cannot open schema file: " + filepath);
 
         std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        auto root = SimpleJSON::parse(json);
+        SimpleJSON root = SimpleJSON::parse(json);
+        start = recordStage("parse", start);
 
         memoryName = root.getString("name");
         if (memoryName.empty()) throw std::runtime_error("Schema missing 'name' field");
 
-        auto vars = root.getArray("variables");
+        layoutMode = root.getString("layout", layoutMode);
+        if (layoutMode != "packed" && layoutMode != "aligned") {
+            throw std::runtime_error("Invalid layout: " + layoutMode);
+        }
+        layoutOptimization = root.getBool("optimizeLayout", layoutOptimization);
+        emitVirtualPLC = root.getBool("virtualPlc", emitVirtualPLC);
+        lockstep = root.getBool("lockstep", lockstep);
+        statsWindowMs = root.getDouble("statsWindowMs", statsWindowMs);
+        if (!(statsWindowMs > 0)) throw std::runtime_error("statsWindowMs must be positive");
+        timeStep = root.getInt("timeStep", timeStep);
+        if (timeStep < 0) throw std::runtime_error("timeStep must not be negative");
+
+        const auto& vars = root.getArray("variables");
+        variables.reserve(variables.size() + vars.size());
+        std::vector<size_t> wordsAt;        // Position of each new bit group's words in 'variables'
+        size_t firstGroup = bitGroups.size();
         for (const auto& v : vars) {
             Variable var;
             var.name = v.getString("name");
@@ -72,14 +272,291 @@ public:
             if (var.type == "STRING" && var.size == 0) {
                 throw std::runtime_error("STRING type requires 'size' field: " + var.name);
             }
+
+            std::string access = v.getString("access", "normal");
+            if (access != "hot" && access != "normal" && access != "cold") {
+                throw std::runtime_error("Invalid access: " + access + " (" + var.name + ")");
+            }
+            var.hot = (access == "hot");
+
+            var.waveform = v.getString("waveform");
+            if (!var.waveform.empty() && var.waveform != "sine" && var.waveform != "step" &&
+                var.waveform != "ramp" && var.waveform != "random") {
+                throw std::runtime_error("Invalid waveform: " + var.waveform + " (" + var.name + ")");
+            }
+            var.amplitude = v.getDouble("amplitude", var.amplitude);
+            var.period = v.getDouble("period", var.period);
+            if (!(var.period > 0)) throw std::runtime_error("Waveform period must be positive: " + var.name);
+            var.offset = v.getDouble("offset", var.offset);
+
+            // "encoding": "REAL" or {"type": "INT", "scale": 0.001, "offset": 0, "group": "Joints"}
+            if (const SimpleJSON* enc = v.getObject("encoding")) {
+                var.encoding = enc->getString("type");
+                var.encodingScale = enc->getDouble("scale", 1.0);
+                var.encodingOffset = enc->getDouble("offset", 0.0);
+                var.group = enc->getString("group");
+            } else {
+                var.encoding = v.getString("encoding");
+            }
+            if (!var.encoding.empty()) validateEncoding(var);
+
+            // "device": {"type": "GPS", "name": "gps", "period": 32, "index": 2} or "none";
+            // without a declaration fromCPP LREALs read the PositionSensor of the same name
+            if (const SimpleJSON* dev = v.getObject("device")) {
+                var.deviceType = dev->getString("type");
+                var.deviceName = dev->getString("name", var.name);
+                var.devicePeriod = dev->getInt("period", 0);
+                var.deviceIndex = dev->getInt("index", 0);
+                validateDevice(var);
+            } else if (v.getString("device") != "none" && var.direction == "fromCPP" && var.type == "LREAL") {
+                var.deviceType = "PositionSensor";
+                var.deviceName = var.name;
+            }
+
+            // "physics": "FOREARM" or {"body": "FOREARM", "value": "position", "gain": 20,
+            // "maxVelocity": 3.14, "maxForce": 1000}; replaces the motor or device of the variable
+            if (const SimpleJSON* phys = v.getObject("physics")) {
+                if (v.getObject("device")) throw std::runtime_error("physics replaces the device binding: " + var.name);
+                var.physicsBody = phys->getString("body");
+                var.physicsValue = phys->getString("value", "position");
+                var.physicsGain = phys->getDouble("gain", var.physicsGain);
+                var.physicsMaxVelocity = phys->getDouble("maxVelocity", var.physicsMaxVelocity);
+                var.physicsMaxForce = phys->getDouble("maxForce", var.physicsMaxForce);
+            } else {
+                var.physicsBody = v.getString("physics");
+                if (!var.physicsBody.empty()) var.physicsValue = "position";
+            }
+            if (!var.physicsBody.empty()) {
+                validatePhysics(var);
+                var.deviceType.clear();
+                var.deviceName.clear();
+            }
+
+            // "writer": "LeftArm" moves a fromCPP variable into the partition of that writer
+            var.writer = v.getString("writer");
+            if (!var.writer.empty()) validateWriter(var);
+
+            var.stats = v.getBool("stats", false);
+            if (var.stats && var.type == "STRING") {
+                throw std::runtime_error("stats requires a numeric variable: " + var.name);
+            }
+
+            // "bitGroup": "Inputs" packs the BOOL into the words of that group
+            var.bitGroup = v.getString("bitGroup");
+            if (!var.bitGroup.empty()) {
+                if (var.type != "BOOL") throw std::runtime_error("bitGroup requires a BOOL variable: " + var.name);
+                if (var.stats) throw std::runtime_error("stats are not available for packed bits: " + var.name);
+                auto group = std::find_if(bitGroups.begin(), bitGroups.end(),
+                                          [&](const BitGroup& g) { return g.name == var.bitGroup; });
+                if (group == bitGroups.end()) {
+                    bitGroups.push_back(BitGroup());
+                    bitGroups.back().name = var.bitGroup;
+                    bitGroups.back().direction = var.direction;
+                    bitGroups.back().writer = var.writer;
+                    wordsAt.push_back(variables.size());
+                    group = bitGroups.end() - 1;
+                } else if (group->direction != var.direction) {
+                    throw std::runtime_error("Bit group mixes directions: " + var.bitGroup);
+                } else if (group->writer != var.writer) {
+                    throw std::runtime_error("Bit group mixes writers: " + var.bitGroup);
+                }
+                var.bitIndex = static_cast<int>(group->bits.size());
+                group->bits.push_back(std::move(var));
+                continue;
+            }
             
-            variables.push_back(var);
+            variables.push_back(std::move(var));
+        }
+
+        // Words replace the bits at the position of each group's first bit
+        std::set<std::string> memberNames;
+        for (const auto& v : variables) memberNames.insert(capitalize(v.name));
+        for (size_t g = bitGroups.size(); g-- > firstGroup;) {
+            BitGroup& group = bitGroups[g];
+            group.wordType = group.bits.size() <= 32 ? "DWORD" : "LWORD";
+            group.wordBits = group.bits.size() <= 32 ? 32 : 64;
+            std::vector<Variable> words((group.bits.size() + group.wordBits - 1) / group.wordBits);
+            for (size_t w = 0; w < words.size(); w++) {
+                words[w].name = bitWordName(group.name, w);
+                if (memberNames.count(capitalize(words[w].name))) {
+                    throw std::runtime_error("Bit group word clashes with a variable: " + words[w].name);
+                }
+                words[w].type = group.wordType;
+                words[w].direction = group.direction;
+                words[w].writer = group.writer;
+                words[w].bitGroup = group.name;
+                words[w].bitIndex = static_cast<int>(w);
+            }
+            for (const Variable& bit : group.bits) words[bit.bitIndex / group.wordBits].hot |= bit.hot;
+            variables.insert(variables.begin() + wordsAt[g - firstGroup], words.begin(), words.end());
+        }
+
+        // Bulk accessors share the client namespace with the per-variable ones
+        // and convert within one block, so a group has one direction and writer
+        std::map<std::string, std::string> groupDirection;
+        for (const auto& v : variables) {
+            if (v.encoding.empty()) continue;
+            auto it = groupDirection.insert(std::make_pair(encodingGroup(v), v.direction + "/" + v.writer)).first;
+            if (it->second != v.direction + "/" + v.writer) {
+                throw std::runtime_error("Encoding group mixes directions or writers: " + it->first);
+            }
+        }
+        for (const auto& v : variables) {
+            if (groupDirection.count(capitalize(v.name))) {
+                throw std::runtime_error("Encoding group clashes with variable: " + v.name);
+            }
+        }
+        std::set<std::string> accessorNames;
+        for (const auto& v : variables) accessorNames.insert(capitalize(v.name));
+        for (const auto& g : bitGroups) {
+            if (groupDirection.count(g.name) || accessorNames.count(capitalize(g.name))) {
+                throw std::runtime_error("Bit group clashes with a variable or encoding group: " + g.name);
+            }
+            for (const auto& bit : g.bits) {
+                if (!accessorNames.insert(capitalize(bit.name)).second) {
+                    throw std::runtime_error("Duplicate variable: " + bit.name);
+                }
+            }
         }
         
         // Generate UUIDs once for consistency
         uuidMain = generateUUID();
         uuidToCPP = generateUUID();
         uuidFromCPP = generateUUID();
+        uuidHeader = generateUUID();
+        uuidLockstep = generateUUID();
+        uuidGeneration = generateUUID();
+        for (const auto& v : variables) {
+            if (v.writer.empty() || uuidWriters.count(v.writer)) continue;
+            uuidWriters[v.writer] = generateUUID();
+            writerNames.push_back(v.writer);
+        }
+
+        indexValid = false;
+        recordStage("load", start);
+    }
+
+    /**
+     * Record the time since 'start' as a stage of the timing report
+     * @return Start time of the next stage
+     */
+    std::chrono::steady_clock::time_point recordStage(const std::string& stage, std::chrono::steady_clock::time_point start) {
+        auto now = std::chrono::steady_clock::now();
+        stageTimes.push_back(std::make_pair(stage, std::chrono::duration<double, std::milli>(now - start).count()));
+        return now;
+    }
+
+    /**
+     * Index the schema once for all emitters: directions split, accessor
+     * names, encoding groups and the segment layout. Must be rebuilt after
+     * anything that changes order or layout (optimizeLayout, layoutMode).
+     */
+    void buildModel() {
+        indexed = Model();
+        indexed.lowerName = memoryName;
+        std::transform(indexed.lowerName.begin(), indexed.lowerName.end(), indexed.lowerName.begin(), ::tolower);
+
+        indexed.capitalized.reserve(variables.size());
+        indexed.writers.resize(writerNames.size());
+        for (size_t w = 0; w < writerNames.size(); w++) indexed.writers[w].name = writerNames[w];
+        for (size_t i = 0; i < variables.size(); i++) {
+            const Variable& v = variables[i];
+            if (!v.writer.empty()) {
+                indexed.writers[writerIndex(v.writer)].fields.push_back(i);
+            } else {
+                (v.direction == "toCPP" ? indexed.toCPP : indexed.fromCPP).push_back(i);
+            }
+            indexed.capitalized.push_back(capitalize(v.name));
+            if (!v.encoding.empty()) indexed.groups[encodingGroup(v)].push_back(i);
+            if (v.stats) indexed.stats.push_back(i);
+            if (!v.physicsBody.empty()) indexed.physics.push_back(i);
+        }
+        indexed.layout = computeLayout();
+        indexed.layoutHash = layoutHash(indexed.layout);
+        std::string statsText = "stats";
+        for (size_t i : indexed.stats) statsText += ";" + variables[i].name;
+        indexed.statsHash = fnv1a(statsText);
+        indexValid = true;
+    }
+
+    const Model& model() {
+        if (!indexValid) buildModel();
+        return indexed;
+    }
+
+    static void validateEncoding(const Variable& var) {
+        if (var.type != "LREAL" && var.type != "REAL") {
+            throw std::runtime_error("Encoding requires an LREAL or REAL variable: " + var.name);
+        }
+        const std::string& e = var.encoding;
+        if (e != "REAL" && e != "SINT" && e != "INT" && e != "DINT" &&
+            e != "USINT" && e != "UINT" && e != "UDINT") {
+            throw std::runtime_error("Invalid encoding: " + e + " (" + var.name + ")");
+        }
+        if (var.encodingScale == 0.0) {
+            throw std::runtime_error("Encoding scale must not be zero: " + var.name);
+        }
+    }
+
+    static void validateDevice(const Variable& var) {
+        const std::string& t = var.deviceType;
+        if (t != "PositionSensor" && t != "TouchSensor" && t != "InertialUnit" && t != "GPS" &&
+            t != "DistanceSensor" && t != "TorqueFeedback") {
+            throw std::runtime_error("Invalid device type: " + t + " (" + var.name + ")");
+        }
+        if (var.direction != "fromCPP") {
+            throw std::runtime_error("Devices feed fromCPP variables: " + var.name);
+        }
+        if (var.type == "STRING") {
+            throw std::runtime_error("Device requires a numeric variable: " + var.name);
+        }
+        if (var.devicePeriod < 0) {
+            throw std::runtime_error("Device period must not be negative: " + var.name);
+        }
+        int components = (t == "GPS" || t == "InertialUnit") ? 3 : 1;
+        if (var.deviceIndex < 0 || var.deviceIndex >= components) {
+            throw std::runtime_error("Device index out of range: " + var.name);
+        }
+    }
+
+    static void validatePhysics(const Variable& var) {
+        if (var.type != "LREAL" && var.type != "REAL") {
+            throw std::runtime_error("physics requires an LREAL or REAL variable: " + var.name);
+        }
+        if (var.physicsValue != "position" && var.physicsValue != "velocity") {
+            throw std::runtime_error("Invalid physics value: " + var.physicsValue + " (" + var.name + ")");
+        }
+        if (!(var.physicsGain > 0) || !(var.physicsMaxVelocity > 0) || !(var.physicsMaxForce > 0)) {
+            throw std::runtime_error("physics gain, maxVelocity and maxForce must be positive: " + var.name);
+        }
+    }
+
+    // Writer names become struct members, types and class names on both sides
+    static void validateWriter(const Variable& var) {
+        if (var.direction != "fromCPP") throw std::runtime_error("writer requires a fromCPP variable: " + var.name);
+        if (!var.physicsBody.empty()) throw std::runtime_error("physics variables are written by the plugin, not a writer: " + var.name);
+        if (var.writer == "FromCPP") throw std::runtime_error("Writer name is reserved: FromCPP (" + var.name + ")");
+        bool identifier = !std::isdigit(static_cast<unsigned char>(var.writer[0]));
+        for (char c : var.writer) identifier = identifier && (std::isalnum(static_cast<unsigned char>(c)) || c == '_');
+        if (!identifier) throw std::runtime_error("Invalid writer: " + var.writer + " (" + var.name + ")");
+    }
+
+    // Webots class and read expression of a device binding
+    static std::string deviceClass(const std::string& type) {
+        return type == "TorqueFeedback" ? "Motor" : type;
+    }
+
+    static std::string deviceRead(const Variable& var) {
+        if (var.deviceType == "GPS") return "getValues()[" + std::to_string(var.deviceIndex) + "]";
+        if (var.deviceType == "InertialUnit") return "getRollPitchYaw()[" + std::to_string(var.deviceIndex) + "]";
+        if (var.deviceType == "TorqueFeedback") return "getTorqueFeedback()";
+        return "getValue()";
+    }
+
+    static std::string capitalize(const std::string& name) {
+        std::string c = name;
+        if (!c.empty()) c[0] = toupper(c[0]);
+        return c;
     }
 
     std::string generateUUID() {
@@ -132,27 +609,312 @@ public:
     }
 
 
+    // Type a variable is stored as in the segment (its encoding, if any)
+    static const std::string& storageType(const Variable& var) {
+        return var.encoding.empty() ? var.type : var.encoding;
+    }
+
+    // Bulk accessor group of an encoded variable
+    static std::string encodingGroup(const Variable& var) {
+        if (!var.group.empty()) return var.group;
+        return var.direction == "toCPP" ? "ScaledInputs" : "ScaledOutputs";
+    }
+
+    static std::string bitWordName(const std::string& group, size_t word) {
+        return group + "_" + std::to_string(word);
+    }
+
+    size_t writerIndex(const std::string& name) const {
+        return std::find(writerNames.begin(), writerNames.end(), name) - writerNames.begin();
+    }
+
+    // Member of ST_<Name> holding a variable, and its struct type
+    static std::string blockOf(const Variable& var) {
+        if (!var.writer.empty()) return "FromCPP_" + var.writer;
+        return var.direction == "toCPP" ? "ToCPP" : "FromCPP";
+    }
+
+    static std::string blockType(const Variable& var) {
+        return "ST_" + blockOf(var);
+    }
+
+    static bool isBitWord(const Variable& var) {
+        return !var.bitGroup.empty() && var.type != "BOOL";
+    }
+
+    const BitGroup& findBitGroup(const std::string& name) const {
+        for (const auto& g : bitGroups) {
+            if (g.name == name) return g;
+        }
+        throw std::runtime_error("Unknown bit group: " + name);
+    }
+
+    // Word member and mask literal of a packed bit, e.g. "Inputs_1" and "0x20ull"
+    std::string bitWord(const Variable& bit) const {
+        return bitWordName(bit.bitGroup, bit.bitIndex / findBitGroup(bit.bitGroup).wordBits);
+    }
+
+    std::string bitMask(const Variable& bit) const {
+        const BitGroup& g = findBitGroup(bit.bitGroup);
+        char text[32];
+        std::snprintf(text, sizeof(text), "0x%llx%s", 1ull << (bit.bitIndex % g.wordBits), g.wordBits == 64 ? "ull" : "u");
+        return text;
+    }
+
+    // Size of a variable in the segment (IEC 61131-3 elementary types)
+    static size_t typeSize(const Variable& var) {
+        const std::string& t = storageType(var);
+        if (t == "STRING") return static_cast<size_t>(var.size) + 1;
+        if (t == "BOOL" || t == "BYTE" || t == "SINT" || t == "USINT") return 1;
+        if (t == "WORD" || t == "INT" || t == "UINT") return 2;
+        if (t == "DWORD" || t == "DINT" || t == "UDINT" || t == "REAL" || t == "TIME" ||
+            t == "DATE" || t == "TIME_OF_DAY" || t == "TOD" || t == "DATE_AND_TIME" || t == "DT") return 4;
+        if (t == "LWORD" || t == "LINT" || t == "ULINT" || t == "LREAL" || t == "LTIME" ||
+            t == "LDATE" || t == "LTIME_OF_DAY" || t == "LTOD" || t == "LDATE_AND_TIME" || t == "LDT") return 8;
+        throw std::runtime_error("Unsupported type: " + t + " (" + var.name + ")");
+    }
+
+    // Natural alignment of a variable (strings are byte arrays)
+    static size_t typeAlign(const Variable& var) {
+        return var.type == "STRING" ? 1 : typeSize(var);
+    }
+
+    static size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) / align * align;
+    }
+
+    /**
+     * Layout optimizer pass (run between loadSchema and the emitters)
+     * Orders fields hot-first, then by descending alignment, keeping schema
+     * order among equals. Every emitter walks 'variables', so the PLCopenXML
+     * and the C++ types receive the same order.
+     */
+    void optimizeLayout() {
+        std::stable_sort(variables.begin(), variables.end(), [](const Variable& a, const Variable& b) {
+            if (a.hot != b.hot) return a.hot;
+            return typeAlign(a) > typeAlign(b);
+        });
+        indexValid = false;
+    }
+
+    /**
+     * Compute field offsets of ST_<Name> for the current variable order,
+     * following the same rules as the emitted #pragma pack
+     * Writer partitions follow FromCPP, each padded to start on a cache
+     * line, and LifePLC moves to the next line after the last one. In every
+     * mode LifePLC, LifeCPP and ST_Lockstep start on a 4 byte boundary, as
+     * the lockstep futex needs an aligned word.
+     */
+    SegmentLayout computeLayout() const {
+        const bool aligned = (layoutMode == "aligned");
+        SegmentLayout layout;
+        layout.padding = 0;
+        layout.fields.reserve(variables.size());
+
+        // Blocks: 0 ST_ToCPP, 1 ST_FromCPP, 2 + w ST_FromCPP_<Writer> (after Seq and Life)
+        const size_t blocks = 2 + writerNames.size();
+        std::vector<size_t> structAlign(blocks, 1);
+        std::vector<size_t> structSize(blocks, 0);
+        for (size_t d = 2; d < blocks; d++) {
+            structSize[d] = PARTITION_HEADER_SIZE;
+            if (aligned) structAlign[d] = 4;
+        }
+        std::vector<size_t> blockOfField(variables.size());
+        std::vector<size_t> localOffset(variables.size());
+        for (size_t i = 0; i < variables.size(); i++) {
+            const Variable& v = variables[i];
+            size_t d = !v.writer.empty() ? 2 + writerIndex(v.writer) : (v.direction == "toCPP") ? 0 : 1;
+            size_t align = aligned ? typeAlign(v) : 1;
+            size_t offset = alignUp(structSize[d], align);
+            layout.padding += offset - structSize[d];
+            blockOfField[i] = d;
+            localOffset[i] = offset;
+            structSize[d] = offset + typeSize(v);
+            structAlign[d] = std::max(structAlign[d], align);
+        }
+        // Empty ST_ToCPP / ST_FromCPP hold a dummy placeholder byte
+        if (structSize[0] == 0) structSize[0] = 1;
+        if (structSize[1] == 0) structSize[1] = 1;
+        for (size_t d = 0; d < blocks; d++) {
+            size_t padded = alignUp(structSize[d], structAlign[d]);
+            layout.padding += padded - structSize[d];
+            structSize[d] = padded;
+        }
+
+        size_t pos = SEGMENT_HEADER_SIZE;
+        layout.toCPPOffset = alignUp(pos, structAlign[0]);
+        layout.padding += layout.toCPPOffset - pos;
+        layout.toCPPSize = structSize[0];
+        pos = layout.toCPPOffset + structSize[0];
+        layout.fromCPPOffset = alignUp(pos, structAlign[1]);
+        layout.padding += layout.fromCPPOffset - pos;
+        layout.fromCPPSize = structSize[1];
+        pos = layout.fromCPPOffset + structSize[1];
+        std::vector<size_t> blockOffset = {layout.toCPPOffset, layout.fromCPPOffset};
+        for (size_t w = 0; w < writerNames.size(); w++) {
+            PartitionSlot slot;
+            slot.name = writerNames[w];
+            slot.offset = alignUp(pos, CACHE_LINE);
+            slot.padding = slot.offset - pos;
+            slot.size = structSize[2 + w];
+            layout.padding += slot.padding;
+            layout.partitions.push_back(slot);
+            blockOffset.push_back(slot.offset);
+            pos = slot.offset + slot.size;
+        }
+        layout.lifePadding = alignUp(pos, writerNames.empty() ? 4 : CACHE_LINE) - pos;
+        layout.padding += layout.lifePadding;
+        pos += layout.lifePadding;
+        layout.lifePLCOffset = pos;
+        layout.lifeCPPOffset = layout.lifePLCOffset + 4;
+        pos = layout.lifeCPPOffset + 4;
+        layout.lockstepOffset = 0;
+        if (lockstep) {
+            layout.lockstepOffset = pos;    // Follows LifeCPP, so 4 byte aligned via Pad_Life
+            pos += LOCKSTEP_SIZE;
+        }
+        size_t mainAlign = aligned ? std::max<size_t>(4, *std::max_element(structAlign.begin(), structAlign.end())) : 1;
+        layout.totalSize = alignUp(pos, mainAlign);
+        layout.padding += layout.totalSize - pos;
+
+        for (size_t i = 0; i < variables.size(); i++) {
+            const Variable& v = variables[i];
+            FieldSlot slot;
+            slot.name = v.name;
+            slot.type = storageType(v);
+            slot.direction = v.direction;
+            slot.offset = blockOffset[blockOfField[i]] + localOffset[i];
+            slot.size = typeSize(v);
+            slot.align = typeAlign(v);
+            slot.hot = v.hot;
+            layout.fields.push_back(slot);
+        }
+        return layout;
+    }
+
+    /**
+     * Fingerprint of the segment layout (FNV-1a, 32 bit)
+     * Covers packing, size and every field's name, storage type, direction,
+     * offset and encoding, so a regenerated struct with the same sizeof but
+     * a different layout is still told apart.
+     */
+    uint32_t layoutHash(const SegmentLayout& layout) const {
+        std::ostringstream text;
+        text << layoutMode << ";" << layout.totalSize << ";" << layout.fromCPPOffset << ";" << layout.lifePLCOffset;
+        if (layout.lockstepOffset) text << ";lockstep:" << layout.lockstepOffset;
+        for (const auto& p : layout.partitions) text << ";writer:" << p.name << ":" << p.offset << ":" << p.size;
+        for (size_t i = 0; i < layout.fields.size(); i++) {
+            const FieldSlot& f = layout.fields[i];
+            text << ";" << f.name << ":" << f.type << ":" << f.direction << ":" << f.offset << ":" << f.size;
+            if (!variables[i].encoding.empty()) {
+                text << ":" << literal(variables[i].encodingScale) << ":" << literal(variables[i].encodingOffset);
+            }
+        }
+        for (const auto& g : bitGroups) {
+            for (const auto& bit : g.bits) text << ";bit:" << bit.name << ":" << g.name << ":" << bit.bitIndex;
+        }
+
+        return fnv1a(text.str());
+    }
+
+    static uint32_t fnv1a(const std::string& text) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    static std::string hex32(uint32_t value) {
+        char text[9];
+        std::snprintf(text, sizeof(text), "%08X", value);
+        return text;
+    }
+
+    // Cache lines touched by one exchange cycle (hot fields, or all fields if none are hot)
+    static size_t cacheLinesPerCycle(const SegmentLayout& layout, size_t lineSize = 64) {
+        bool anyHot = false;
+        for (const auto& f : layout.fields) anyHot = anyHot || f.hot;
+
+        std::vector<bool> touched(layout.totalSize / lineSize + 1, false);
+        auto touch = [&](size_t offset, size_t size) {
+            for (size_t line = offset / lineSize; line <= (offset + size - 1) / lineSize; line++) touched[line] = true;
+        };
+        for (const auto& f : layout.fields) {
+            if (!anyHot || f.hot) touch(f.offset, f.size);
+        }
+        touch(0, SEGMENT_HEADER_SIZE);      // Generation is checked on every Sync
+        touch(layout.lifePLCOffset, 8);
+        for (const auto& p : layout.partitions) touch(p.offset, PARTITION_HEADER_SIZE);
+        if (layout.lockstepOffset) touch(layout.lockstepOffset, LOCKSTEP_SIZE);
+        return static_cast<size_t>(std::count(touched.begin(), touched.end(), true));
+    }
+
+    static size_t misalignedFields(const SegmentLayout& layout) {
+        size_t count = 0;
+        for (const auto& f : layout.fields) {
+            if (f.offset % f.align != 0) count++;
+        }
+        return count;
+    }
+
     std::string typeToXML(const Variable& var) {
         if (var.type == "STRING") return "<string />";
-        return "<" + var.type + " />";
+        return "<" + storageType(var) + " />";
+    }
+
+    // Conversion rule of an encoded variable, e.g. "LREAL = raw * 0.001 + 0"
+    static std::string encodingRule(const Variable& var) {
+        std::ostringstream rule;
+        rule << var.type << " = raw * " << literal(var.encodingScale);
+        if (var.encodingOffset != 0.0) {
+            rule << (var.encodingOffset < 0 ? " - " : " + ") << literal(std::fabs(var.encodingOffset));
+        }
+        return rule.str();
+    }
+
+    // Bit assignment of a packed word, e.g. "Bits of Inputs: .0 door_closed, .1 light_curtain"
+    std::string bitWordContents(const Variable& word) const {
+        const BitGroup& g = findBitGroup(word.bitGroup);
+        std::string text = "Bits of " + g.name + ":";
+        size_t first = word.bitIndex * g.wordBits;
+        for (size_t b = first; b < std::min(g.bits.size(), first + g.wordBits); b++) {
+            text += (b == first ? " ." : ", .") + std::to_string(b - first) + " " + g.bits[b].name;
+        }
+        return text;
     }
 
-    void generateVariable(std::ostream& out, const Variable& var, int indent = 12) {
-        std::string spaces(indent, ' ');
+    void generateVariable(OutputBuffer& out, const Variable& var, int indent = 12) {
+        const std::string spaces(indent, ' ');
         out << spaces << "<variable name=\"" << var.name << "\">\n";
         out << spaces << "  <type>\n";
         out << spaces << "    " << typeToXML(var) << "\n";
         out << spaces << "  </type>\n";
+        if (!var.encoding.empty()) {
+            out << spaces << "  <documentation>\n";
+            out << spaces << "    <xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> " << encodingRule(var) << " </xhtml>\n";
+            out << spaces << "  </documentation>\n";
+        } else if (isBitWord(var)) {
+            out << spaces << "  <documentation>\n";
+            out << spaces << "    <xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> " << bitWordContents(var) << " </xhtml>\n";
+            out << spaces << "  </documentation>\n";
+        }
         out << spaces << "</variable>\n";
     }
 
-    void generateStruct(std::ostream& out, const std::string& structName, 
-                        const std::vector<Variable>& fields, const std::string& uuid) {
+    void generateStruct(OutputBuffer& out, const std::string& structName, 
+                        const std::vector<size_t>& fields, const std::string& uuid, bool partition = false) {
         out << "      <dataType name=\"" << structName << "\">\n";
         out << "        <baseType>\n";
         out << "          <struct>\n";
+
+        if (partition) {
+            out << "            <variable name=\"Seq\"><type><UDINT /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> Odd while the writer updates the block; copy it while Seq is even and unchanged </xhtml></documentation></variable>\n";
+            out << "            <variable name=\"Life\"><type><DINT /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> Heartbeat counter of the writer </xhtml></documentation></variable>\n";
+        }
         
-        if (fields.empty()) {
+        if (fields.empty() && !partition) {
             out << "            <variable name=\"dummy\">\n";
             out << "              <type>\n";
             out << "                <BYTE />\n";
@@ -162,14 +924,15 @@ public:
             out << "              </documentation>\n";
             out << "            </variable>\n";
         } else {
-            for (const auto& var : fields) {
-                generateVariable(out, var);
+            for (size_t i : fields) {
+                generateVariable(out, variables[i]);
             }
         }
         
         out << "          </struct>\n";
         out << "        </baseType>\n";
         out << "        <addData>\n";
+        out << "          " << packModeData() << "\n";
         out << "          <data name=\"http://www.3s-software.com/plcopenxml/objectid\" handleUnknown=\"discard\">\n";
         out << "            <ObjectId>" << uuid << "</ObjectId>\n";
         out << "          </data>\n";
@@ -179,15 +942,10 @@ public:
 
     // 1. Generate PLCopenXML
     void generatePLCopenXML(const std::string& outputPath) {
-        std::ofstream out(outputPath);
+        const Model& m = model();
+        OutputBuffer out(outputPath, 4096 + variables.size() * 160);
         std::string timestamp = getCurrentTimestamp();
         
-        std::vector<Variable> toCPPVars, fromCPPVars;
-        for (const auto& v : variables) {
-            if (v.direction == "toCPP") toCPPVars.push_back(v);
-            else fromCPPVars.push_back(v);
-        }
-        
         out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
         out << "<project xmlns=\"http://www.plcopen.org/xml/tc6_0200\">\n";
         out << "  <fileHeader companyName=\"\" productName=\"CODESYS\" productVersion=\"CODESYS V3.5 SP20 Patch 3\" creationDateTime=\"" << timestamp << "\" />\n";
@@ -210,216 +968,958 @@ public:
         out << "      <dataType name=\"ST_" << memoryName << "\">\n";
         out << "        <baseType>\n";
         out << "          <struct>\n";
+        out << "            <variable name=\"Header\"><type><derived name=\"ST_SegmentHeader\" /></type>"
+            << "<initialValue><structValue>"
+            << "<value member=\"Magic\"><simpleValue value=\"16#" << hex32(SEGMENT_MAGIC) << "\" /></value>"
+            << "<value member=\"LayoutHash\"><simpleValue value=\"16#" << hex32(m.layoutHash) << "\" /></value>"
+            << "<value member=\"Generation\"><simpleValue value=\"1\" /></value>"
+            << "<value member=\"Size\"><simpleValue value=\"" << m.layout.totalSize << "\" /></value>"
+            << "</structValue></initialValue>"
+            << "<documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> Segment header, keep first </xhtml></documentation></variable>\n";
         out << "            <variable name=\"ToCPP\"><type><derived name=\"ST_ToCPP\" /></type></variable>\n";
         out << "            <variable name=\"FromCPP\"><type><derived name=\"ST_FromCPP\" /></type></variable>\n";
+        for (const auto& p : m.layout.partitions) {
+            if (p.padding) generatePadding(out, "Pad_" + p.name, p.padding, "Keeps FromCPP_" + p.name + " on cache lines of its own");
+            out << "            <variable name=\"FromCPP_" << p.name << "\"><type><derived name=\"ST_FromCPP_" << p.name
+                << "\" /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> Written by " << p.name
+                << " only </xhtml></documentation></variable>\n";
+        }
+        if (m.layout.lifePadding) {
+            generatePadding(out, "Pad_Life", m.layout.lifePadding, m.writers.empty() ? "Aligns the heartbeats and lockstep counters to 4 bytes"
+                                                                                     : "Keeps the heartbeats off the writer partitions");
+        }
         out << "            <variable name=\"LifePLC\"><type><DINT /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> PLC heartbeat counter </xhtml></documentation></variable>\n";
         out << "            <variable name=\"LifeCPP\"><type><DINT /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> C++ heartbeat counter </xhtml></documentation></variable>\n";
+        if (lockstep) {
+            out << "            <variable name=\"Lockstep\"><type><derived name=\"ST_Lockstep\" /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> Lockstep handshake with the simulation </xhtml></documentation></variable>\n";
+        }
         out << "          </struct>\n";
         out << "        </baseType>\n";
-        out << "        <addData><data name=\"http://www.3s-software.com/plcopenxml/objectid\" handleUnknown=\"discard\"><ObjectId>" << uuidMain << "</ObjectId></data></addData>\n";
+        out << "        <addData>" << packModeData() << "<data name=\"http://www.3s-software.com/plcopenxml/objectid\" handleUnknown=\"discard\"><ObjectId>" << uuidMain << "</ObjectId></data></addData>\n";
         out << "      </dataType>\n";
         
-        generateStruct(out, "ST_ToCPP", toCPPVars, uuidToCPP);
-        generateStruct(out, "ST_FromCPP", fromCPPVars, uuidFromCPP);
+        generateHeaderStruct(out);
+        if (lockstep) generateLockstepStruct(out);
+        generateStruct(out, "ST_ToCPP", m.toCPP, uuidToCPP);
+        generateStruct(out, "ST_FromCPP", m.fromCPP, uuidFromCPP);
+        for (const auto& w : m.writers) generateStruct(out, "ST_FromCPP_" + w.name, w.fields, uuidWriters[w.name], true);
         
         out << "    </dataTypes>\n";
-        out << "    <pous />\n";
+        out << "    <pous>\n";
+        generateGenerationPou(out);
+        out << "    </pous>\n";
         out << "  </types>\n";
         out << "  <instances><configurations /></instances>\n";
         out << "  <addData>\n";
         out << "    <data name=\"http://www.3s-software.com/plcopenxml/projectstructure\" handleUnknown=\"discard\">\n";
         out << "      <ProjectStructure>\n";
         out << "        <Object Name=\"ST_" << memoryName << "\" ObjectId=\"" << uuidMain << "\" />\n";
+        out << "        <Object Name=\"ST_SegmentHeader\" ObjectId=\"" << uuidHeader << "\" />\n";
+        if (lockstep) out << "        <Object Name=\"ST_Lockstep\" ObjectId=\"" << uuidLockstep << "\" />\n";
         out << "        <Object Name=\"ST_ToCPP\" ObjectId=\"" << uuidToCPP << "\" />\n";
         out << "        <Object Name=\"ST_FromCPP\" ObjectId=\"" << uuidFromCPP << "\" />\n";
+        for (const auto& w : m.writers) {
+            out << "        <Object Name=\"ST_FromCPP_" << w.name << "\" ObjectId=\"" << uuidWriters[w.name] << "\" />\n";
+        }
+        out << "        <Object Name=\"FB_" << memoryName << "Generation\" ObjectId=\"" << uuidGeneration << "\" />\n";
         out << "      </ProjectStructure>\n";
         out << "    </data>\n";
         out << "  </addData>\n";
         out << "</project>\n";
     }
 
+    /**
+     * {attribute 'pack_mode'} of every generated struct, so CODESYS lays them
+     * out like the C++ side: '1' for packed, '8' (natural alignment) for aligned
+     */
+    std::string packModeData() const {
+        return std::string("<data name=\"http://www.3s-software.com/plcopenxml/attributes\" handleUnknown=\"implementation\">"
+                           "<Attributes><Attribute Name=\"pack_mode\" Value=\"") + (layoutMode == "aligned" ? "8" : "1") +
+               "\" /></Attributes></data>";
+    }
+
+    void generatePadding(OutputBuffer& out, const std::string& name, size_t bytes, const std::string& note) {
+        out << "            <variable name=\"" << name << "\"><type><array><dimension lower=\"0\" upper=\"" << bytes - 1
+            << "\" /><baseType><BYTE /></baseType></array></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> "
+            << note << " </xhtml></documentation></variable>\n";
+    }
+
+    void generateHeaderStruct(OutputBuffer& out) {
+        static const char* const members[][2] = {
+            {"Magic", "16#31425743 ('CWB1') once the header is valid"},
+            {"LayoutHash", "Fingerprint of the generated layout"},
+            {"Generation", "Set to a new value whenever the PLC (re)initializes the segment"},
+            {"Size", "SIZEOF the whole segment"},
+        };
+        generateWordStruct(out, "ST_SegmentHeader", "UDINT", members, 4, uuidHeader);
+    }
+
+    void generateLockstepStruct(OutputBuffer& out) {
+        static const char* const members[][2] = {
+            {"Enable", "Set to 1 by the controller while it runs in lockstep, free-run on 0"},
+            {"StepMs", "Simulated milliseconds per step"},
+            {"PlcDone", "Cycles completed by the PLC; run a cycle only while SimDone = PlcDone"},
+            {"SimDone", "Steps completed by the simulation"},
+        };
+        generateWordStruct(out, "ST_Lockstep", "DINT", members, 4, uuidLockstep);
+    }
+
+    /**
+     * FB_<Name>Generation: writes a new Header.Generation once per PLC start
+     * Controllers remap and re-arm the lockstep handshake when it changes.
+     * A retained start counter covers warm restarts, TIME() (milliseconds
+     * since the runtime started) cold starts and downloads.
+     */
+    void generateGenerationPou(OutputBuffer& out) {
+        out << "      <pou name=\"FB_" << memoryName << "Generation\" pouType=\"functionBlock\">\n";
+        out << "        <interface>\n";
+        out << "          <inOutVars>\n";
+        out << "            <variable name=\"Header\"><type><derived name=\"ST_SegmentHeader\" /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> data.Header of the segment </xhtml></documentation></variable>\n";
+        out << "          </inOutVars>\n";
+        out << "          <localVars retain=\"true\">\n";
+        out << "            <variable name=\"Starts\"><type><UDINT /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> Initializations so far, survives warm restarts </xhtml></documentation></variable>\n";
+        out << "          </localVars>\n";
+        out << "          <localVars>\n";
+        out << "            <variable name=\"Done\"><type><BOOL /></type></variable>\n";
+        out << "            <variable name=\"Value\"><type><UDINT /></type></variable>\n";
+        out << "          </localVars>\n";
+        out << "        </interface>\n";
+        out << "        <body>\n";
+        out << "          <ST>\n";
+        out << "            <xhtml xmlns=\"http://www.w3.org/1999/xhtml\">(* Call before FB_GenericSharedMem; runs once per PLC start *)\n";
+        out << "IF NOT Done THEN\n";
+        out << "    Starts := Starts + 1;\n";
+        out << "    Value := (Starts * 16#9E3779B1) XOR TIME_TO_UDINT(TIME());\n";
+        out << "    IF Value &lt; 2 THEN\n";
+        out << "        Value := Value + 2;    (* 0 means no header, 1 is the initial value *)\n";
+        out << "    END_IF\n";
+        out << "    Header.Generation := Value;\n";
+        out << "    Done := TRUE;\n";
+        out << "END_IF</xhtml>\n";
+        out << "          </ST>\n";
+        out << "        </body>\n";
+        out << "        <addData><data name=\"http://www.3s-software.com/plcopenxml/objectid\" handleUnknown=\"discard\"><ObjectId>" << uuidGeneration << "</ObjectId></data></addData>\n";
+        out << "      </pou>\n";
+    }
+
+    void generateWordStruct(OutputBuffer& out, const char* name, const char* type,
+                            const char* const members[][2], size_t count, const std::string& uuid) {
+        out << "      <dataType name=\"" << name << "\">\n";
+        out << "        <baseType>\n";
+        out << "          <struct>\n";
+        for (size_t i = 0; i < count; i++) {
+            out << "            <variable name=\"" << members[i][0] << "\"><type><" << type << " /></type><documentation><xhtml xmlns=\"http://www.w3.org/1999/xhtml\"> "
+                << members[i][1] << " </xhtml></documentation></variable>\n";
+        }
+        out << "          </struct>\n";
+        out << "        </baseType>\n";
+        out << "        <addData>" << packModeData() << "<data name=\"http://www.3s-software.com/plcopenxml/objectid\" handleUnknown=\"discard\"><ObjectId>" << uuid << "</ObjectId></data></addData>\n";
+        out << "      </dataType>\n";
+    }
+
     // 2. Generate C++ Types
     void generateCppTypes(const std::string& outputPath) {
-        std::ofstream out(outputPath);
+        const Model& m = model();
+        OutputBuffer out(outputPath, 1024 + variables.size() * 48);
         
         out << "#pragma once\n";
         out << "#include \"CodesysTypes.hpp\"\n";
         out << "#include <cstring>\n\n";
         out << "// Auto-generated from schema: " << memoryName << "\n\n";
-        out << "#pragma pack(push, 1)\n\n";
+        out << (layoutMode == "aligned" ? "#pragma pack(push, 8)\n\n" : "#pragma pack(push, 1)\n\n");
 
-        out << "struct ST_ToCPP {\n";
-        for (const auto& v : variables) {
-            if (v.direction == "toCPP") {
-                out << "    ";
-                if (v.type == "STRING") {
-                    out << "char " << v.name << "[" << (v.size + 1) << "];  // STRING[" << v.size << "] + null\n";
-                } else {
-                    out << v.type << " " << v.name << ";\n";
-                }
-            }
+        out << "#ifndef ST_SEGMENT_HEADER_DEFINED\n";
+        out << "#define ST_SEGMENT_HEADER_DEFINED\n";
+        out << "struct ST_SegmentHeader {\n";
+        out << "    UDINT Magic;        // 0x31425743 ('CWB1') once the header is valid\n";
+        out << "    UDINT LayoutHash;   // Fingerprint of the generated layout\n";
+        out << "    UDINT Generation;   // New value whenever the PLC (re)initializes the segment\n";
+        out << "    UDINT Size;         // sizeof the whole segment\n";
+        out << "};\n";
+        out << "#endif\n\n";
+
+        if (lockstep) {
+            out << "#ifndef ST_LOCKSTEP_DEFINED\n";
+            out << "#define ST_LOCKSTEP_DEFINED\n";
+            out << "struct ST_Lockstep {\n";
+            out << "    DINT Enable;        // 1 while the controller runs in lockstep\n";
+            out << "    DINT StepMs;        // Simulated milliseconds per step\n";
+            out << "    DINT PlcDone;       // Cycles completed by the PLC\n";
+            out << "    DINT SimDone;       // Steps completed by the simulation\n";
+            out << "};\n";
+            out << "#endif\n\n";
         }
+
+        out << "struct ST_ToCPP {\n";
+        for (size_t i : m.toCPP) generateField(out, variables[i]);
+        if (m.toCPP.empty()) out << "    char dummy;  // Empty struct placeholder\n";
         out << "};\n\n";
 
         out << "struct ST_FromCPP {\n";
-        bool hasFromCPP = false;
-        for (const auto& v : variables) {
-            if (v.direction == "fromCPP") {
-                hasFromCPP = true;
-                out << "    ";
-                if (v.type == "STRING") {
-                    out << "char " << v.name << "[" << (v.size + 1) << "];  // STRING[" << v.size << "] + null\n";
-                } else {
-                    out << v.type << " " << v.name << ";\n";
-                }
-            }
-        }
-        if (!hasFromCPP) out << "    char dummy;  // Empty struct placeholder\n";
+        for (size_t i : m.fromCPP) generateField(out, variables[i]);
+        if (m.fromCPP.empty()) out << "    char dummy;  // Empty struct placeholder\n";
         out << "};\n\n";
 
+        for (const auto& w : m.writers) {
+            out << "// Written by " << w.name << " only, on cache lines of its own\n";
+            out << "struct ST_FromCPP_" << w.name << " {\n";
+            out << "    UDINT Seq;          // Odd while " << w.name << " updates the block\n";
+            out << "    DINT Life;          // Heartbeat of " << w.name << "\n";
+            for (size_t i : w.fields) generateField(out, variables[i]);
+            out << "};\n\n";
+        }
+
         out << "struct ST_" << memoryName << " {\n";
+        out << "    static constexpr UDINT LayoutHash = 0x" << hex32(m.layoutHash) << "u;\n\n";
+        out << "    ST_SegmentHeader Header;\n";
         out << "    ST_ToCPP ToCPP;\n";
         out << "    ST_FromCPP FromCPP;\n";
+        for (const auto& p : m.layout.partitions) {
+            if (p.padding) out << "    BYTE Pad_" << p.name << "[" << p.padding << "];\n";
+            out << "    ST_FromCPP_" << p.name << " FromCPP_" << p.name << ";\n";
+        }
+        if (m.layout.lifePadding) out << "    BYTE Pad_Life[" << m.layout.lifePadding << "];\n";
         out << "    DINT LifePLC;\n";
         out << "    DINT LifeCPP;\n";
+        if (lockstep) out << "    ST_Lockstep Lockstep;\n";
         out << "};\n\n";
 
         out << "#pragma pack(pop)\n";
+        if (!m.stats.empty()) generateStatsStruct(out);
+    }
+
+    // Statistics segment (BridgeStats.hpp), naturally aligned, never seen by the PLC
+    void generateStatsStruct(OutputBuffer& out) {
+        const Model& m = model();
+        out << "\n#ifndef ST_FIELD_STATS_DEFINED\n";
+        out << "#define ST_FIELD_STATS_DEFINED\n";
+        out << "struct ST_FieldStats {\n";
+        out << "    LREAL Min, Max, Mean, Rms;\n";
+        out << "};\n";
+        out << "#endif\n\n";
+
+        out << "struct ST_" << memoryName << "Stats {\n";
+        out << "    static constexpr UDINT LayoutHash = 0x" << hex32(m.statsHash) << "u;\n";
+        out << "    static constexpr size_t Count = " << m.stats.size() << ";\n";
+        out << "    static constexpr const char* Names[Count] = {";
+        for (size_t i = 0; i < m.stats.size(); i++) out << (i ? ", " : "") << "\"" << variables[m.stats[i]].name << "\"";
+        out << "};\n\n";
+        out << "    ST_SegmentHeader Header;\n";
+        out << "    UDINT Seq;          // Odd while a window is written\n";
+        out << "    UDINT Window;       // Windows published\n";
+        out << "    UDINT Samples;      // Cycles in the last window\n";
+        out << "    UDINT Reserved;\n";
+        out << "    LREAL WindowMs;\n";
+        out << "    LREAL EndMs;        // Simulation time at the end of the last window\n";
+        out << "    ST_FieldStats Fields[Count];\n";
+        out << "};\n";
+    }
+
+    void generateField(OutputBuffer& out, const Variable& v) {
+        out << "    ";
+        if (v.type == "STRING") {
+            out << "char " << v.name << "[" << (v.size + 1) << "];  // STRING[" << v.size << "] + null\n";
+        } else if (!v.encoding.empty()) {
+            out << v.encoding << " " << v.name << ";  // " << encodingRule(v) << "\n";
+        } else if (isBitWord(v)) {
+            const BitGroup& g = findBitGroup(v.bitGroup);
+            size_t first = v.bitIndex * g.wordBits;
+            out << v.type << " " << v.name << ";  // Bits " << first << ".." << std::min(g.bits.size(), first + g.wordBits) - 1
+                << " of " << g.name << "\n";
+        } else {
+            out << v.type << " " << v.name << ";\n";
+        }
     }
 
     // 3. Generate C++ Client
     void generateCppClient(const std::string& outputPath) {
-        std::ofstream out(outputPath);
-        
-        std::string lowerName = memoryName;
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+        const Model& m = model();
+        OutputBuffer out(outputPath, 1024 + variables.size() * 200);
 
         out << "#pragma once\n";
         out << "#include \"GenericSharedMemory.hpp\"\n";
-        out << "#include \"" << lowerName << "_types.hpp\"\n\n";
+        out << "#include \"BridgeEncoding.hpp\"\n";
+        out << "#include \"" << m.lowerName << "_types.hpp\"\n\n";
         out << "// Auto-generated typed client for: " << memoryName << "\n\n";
 
-        out << "class " << memoryName << "Client : public TypedSharedMemory<ST_" << memoryName << "> {\n";
-        out << "public:\n";
-        out << "    " << memoryName << "Client() : TypedSharedMemory<ST_" << memoryName << ">() {}\n\n";
+        // Getters first, then setters, then packed bits; partition fields go to their writers
+        std::vector<size_t> accessors;
+        accessors.reserve(variables.size());
+        accessors.insert(accessors.end(), m.toCPP.begin(), m.toCPP.end());
+        accessors.insert(accessors.end(), m.fromCPP.begin(), m.fromCPP.end());
+        generateClientClass(out, memoryName + "Client", accessors, bitsOf(""), "", [&]() {
+            generateGroupAccessors(out, "");
+            generateBitGroupAccessors(out, "");
+            generateStatsAccessor(out);
+            for (const auto& w : m.writers) generatePartitionReader(out, w.name);
+        });
 
-        for (const auto& v : variables) {
-            std::string capitalized = v.name;
-            capitalized[0] = toupper(capitalized[0]);
-
-            if (v.direction == "toCPP") {
-                if (v.type == "STRING") {
-                    out << "    const char* Get" << capitalized << "() const {\n";
-                    out << "        return IsConnected() ? GetData()->ToCPP." << v.name << " : \"\";\n";
-                    out << "    }\n\n";
-                } else {
-                    out << "    " << v.type << " Get" << capitalized << "() const {\n";
-                    out << "        return IsConnected() ? GetData()->ToCPP." << v.name << " : 0;\n";
-                    out << "    }\n\n";
-                }
-            }
+        for (const auto& w : m.writers) {
+            out << "\n// Writes the " << w.name << " partition only; Sync advances its Life, not LifeCPP\n";
+            std::string init = "        SetTransport(\"shm\");\n"
+                               "        SetHeartbeat(offsetof(ST_" + memoryName + ", FromCPP_" + w.name + ") + offsetof(ST_FromCPP_" +
+                               w.name + ", Life));\n";
+            generateClientClass(out, memoryName + w.name + "Writer", w.fields, bitsOf(w.name), init, [&]() {
+                generateGroupAccessors(out, w.name);
+                generateBitGroupAccessors(out, w.name);
+                generatePartitionUpdate(out, w.name);
+            });
         }
+    }
 
-        for (const auto& v : variables) {
-            std::string capitalized = v.name;
-            capitalized[0] = toupper(capitalized[0]);
-
-            if (v.direction == "fromCPP") {
-                if (v.type == "STRING") {
-                    out << "    void Set" << capitalized << "(const char* value) {\n";
-                    out << "        if (IsConnected()) {\n";
-                    out << "            strncpy(GetData()->FromCPP." << v.name << ", value, " << v.size << ");\n";
-                    out << "            GetData()->FromCPP." << v.name << "[" << v.size << "] = 0;\n";
-                    out << "        }\n";
-                    out << "    }\n\n";
-                } else {
-                    out << "    void Set" << capitalized << "(" << v.type << " value) {\n";
-                    out << "        if (IsConnected()) GetData()->FromCPP." << v.name << " = value;\n";
-                    out << "    }\n\n";
-                }
-            }
+    // Packed bits of the groups in one block (writer partition, "" = ToCPP and the shared FromCPP)
+    std::vector<const Variable*> bitsOf(const std::string& writer) const {
+        std::vector<const Variable*> bits;
+        for (const auto& g : bitGroups) {
+            if (g.writer != writer) continue;
+            for (const auto& bit : g.bits) bits.push_back(&bit);
         }
-
-        out << "};\n";
+        return bits;
     }
 
-    // 4. Generate Webots Controller
+    /**
+     * One client class over TypedSharedMemory<ST_<Name>>
+     * Compilers slow down quadratically with the member count of one class,
+     * so very large schemas get their accessors spread over a base class
+     * chain; 'init' is the constructor body, 'tail' adds the last members.
+     */
+    template<typename Tail>
+    void generateClientClass(OutputBuffer& out, const std::string& name, const std::vector<size_t>& accessors,
+                             const std::vector<const Variable*>& bits, const std::string& init, Tail tail) {
+        size_t total = accessors.size() + bits.size();
+        const size_t CHUNK = 1024;
+        size_t chunks = total == 0 ? 1 : (total + CHUNK - 1) / CHUNK;
+        std::string base = "TypedSharedMemory<ST_" + memoryName + ">";
+
+        for (size_t c = 0; c < chunks; c++) {
+            bool last = (c + 1 == chunks);
+            std::string className = last ? name : name + "Part" + std::to_string(c);
+
+            out << "class " << className << " : public " << base << " {\n";
+            out << "public:\n";
+            if (last && !init.empty()) {
+                out << "    " << className << "() : " << base << "() {\n";
+                out << init;
+                out << "    }\n\n";
+            } else {
+                out << "    " << className << "() : " << base << "() {}\n\n";
+            }
+
+            for (size_t i = c * CHUNK; i < std::min(total, (c + 1) * CHUNK); i++) {
+                if (i < accessors.size()) generateAccessor(out, accessors[i]);
+                else generateBitAccessor(out, *bits[i - accessors.size()]);
+            }
+            if (last) tail();
+
+            out << "};\n";
+            if (!last) out << "\n";
+            base = className;
+        }
+    }
+
+    // Consistent copy of a writer partition for readers of the whole segment
+    void generatePartitionReader(OutputBuffer& out, const std::string& writer) {
+        std::string type = "ST_FromCPP_" + writer;
+        out << "    // Copy of the " << writer << " partition taken while its Seq was even and unchanged\n";
+        out << "    bool Read" << writer << "(" << type << "& block, int attempts = 100) const {\n";
+        out << "        if (!IsConnected()) return false;\n";
+        out << "        const " << type << "& p = GetData()->FromCPP_" << writer << ";\n";
+        out << "        const volatile UDINT* seq = &p.Seq;\n";
+        out << "        for (int i = 0; i < attempts; i++) {\n";
+        out << "            UDINT before = *seq;\n";
+        out << "            if (before & 1u) continue;\n";
+        out << "            std::atomic_thread_fence(std::memory_order_acquire);\n";
+        out << "            std::memcpy(static_cast<void*>(&block), &p, sizeof(block));\n";
+        out << "            std::atomic_thread_fence(std::memory_order_acquire);\n";
+        out << "            if (*seq == before) return true;\n";
+        out << "        }\n";
+        out << "        return false;\n";
+        out << "    }\n\n";
+    }
+
+    // Seq handshake of a partition writer: BeginUpdate(), setters, EndUpdate(), Sync()
+    void generatePartitionUpdate(OutputBuffer& out, const std::string& writer) {
+        out << "    // Seq is odd from BeginUpdate() to EndUpdate(), readers retry meanwhile\n";
+        out << "    void BeginUpdate() {\n";
+        out << "        if (!IsConnected()) return;\n";
+        out << "        volatile UDINT* seq = &GetData()->FromCPP_" << writer << ".Seq;\n";
+        out << "        *seq = *seq + 1;\n";
+        out << "        std::atomic_thread_fence(std::memory_order_release);\n";
+        out << "    }\n\n";
+        out << "    void EndUpdate() {\n";
+        out << "        if (!IsConnected()) return;\n";
+        out << "        volatile UDINT* seq = &GetData()->FromCPP_" << writer << ".Seq;\n";
+        out << "        std::atomic_thread_fence(std::memory_order_release);\n";
+        out << "        *seq = *seq + 1;\n";
+        out << "    }\n\n";
+        const std::string block = "FromCPP_" + writer;
+        out << "    // Episode reset: the partition fields of 'checkpoint' only, Seq and Life stay live\n";
+        out << "    bool RestoreCheckpoint(const Checkpoint& checkpoint) {\n";
+        out << "        if (!IsConnected() || !checkpoint.valid) return false;\n";
+        out << "        const size_t skip = offsetof(ST_" << block << ", Life) + sizeof(DINT);\n";
+        out << "        BeginUpdate();\n";
+        out << "        std::memcpy(reinterpret_cast<char*>(&GetData()->" << block << ") + skip,\n";
+        out << "                    reinterpret_cast<const char*>(&checkpoint.image." << block << ") + skip, sizeof(ST_" << block << ") - skip);\n";
+        out << "        EndUpdate();\n";
+        out << "        Sync();\n";
+        out << "        return true;\n";
+        out << "    }\n\n";
+    }
+
+    void generateAccessor(OutputBuffer& out, size_t index) {
+        const Variable& v = variables[index];
+        const std::string& capitalized = model().capitalized[index];
+
+        if (v.direction == "toCPP") {
+            if (v.type == "STRING") {
+                out << "    const char* Get" << capitalized << "() const {\n";
+                out << "        return IsConnected() ? GetData()->ToCPP." << v.name << " : \"\";\n";
+                out << "    }\n\n";
+            } else if (!v.encoding.empty()) {
+                out << "    " << v.type << " Get" << capitalized << "() const {\n";
+                out << "        return IsConnected() ? static_cast<" << v.type << ">(BridgeEncoding::Dequantize<" << v.encoding
+                    << ">(GetData()->ToCPP." << v.name << ", " << literal(v.encodingScale) << ", "
+                    << literal(v.encodingOffset) << ")) : 0;\n";
+                out << "    }\n\n";
+            } else {
+                out << "    " << v.type << " Get" << capitalized << "() const {\n";
+                out << "        return IsConnected() ? GetData()->ToCPP." << v.name << " : 0;\n";
+                out << "    }\n\n";
+            }
+        } else {
+            const std::string field = "GetData()->" + blockOf(v) + "." + v.name;
+            if (v.type == "STRING") {
+                out << "    void Set" << capitalized << "(const char* value) {\n";
+                out << "        if (IsConnected()) {\n";
+                out << "            strncpy(" << field << ", value, " << v.size << ");\n";
+                out << "            " << field << "[" << v.size << "] = 0;\n";
+                out << "        }\n";
+                out << "    }\n\n";
+            } else if (!v.encoding.empty()) {
+                out << "    void Set" << capitalized << "(" << v.type << " value) {\n";
+                out << "        if (IsConnected()) " << field << " = BridgeEncoding::Quantize<" << v.encoding
+                    << ">(value, " << literal(v.encodingScale) << ", " << literal(v.encodingOffset) << ");\n";
+                out << "    }\n\n";
+            } else {
+                out << "    void Set" << capitalized << "(" << v.type << " value) {\n";
+                out << "        if (IsConnected()) " << field << " = value;\n";
+                out << "    }\n\n";
+            }
+        }
+    }
+
+    /**
+     * Bulk conversion accessors, one Get<Group>/Set<Group> per encoding group
+     * Members that are adjacent in the segment and share a raw type are
+     * converted as one run, which the compiler can vectorize.
+     */
+    void generateGroupAccessors(OutputBuffer& out, const std::string& writer) {
+        const Model& m = model();
+        const SegmentLayout& layout = m.layout;
+
+        for (const auto& g : m.groups) {
+            const std::vector<size_t>& members = g.second;
+            if (variables[members[0]].writer != writer) continue;
+            bool toCPP = (variables[members[0]].direction == "toCPP");
+            const std::string block = blockOf(variables[members[0]]);
+
+            out << "    // Encoding group " << g.first << " (" << members.size() << " variables)\n";
+            out << "    static constexpr size_t " << g.first << "Count = " << members.size() << ";\n\n";
+            if (toCPP) out << "    void Get" << g.first << "(LREAL* values) const {\n";
+            else out << "    void Set" << g.first << "(const LREAL* values) {\n";
+
+            out << "        static const double scale[] = {";
+            for (size_t i = 0; i < members.size(); i++) out << (i ? ", " : "") << literal(variables[members[i]].encodingScale);
+            out << "};\n";
+            out << "        static const double offset[] = {";
+            for (size_t i = 0; i < members.size(); i++) out << (i ? ", " : "") << literal(variables[members[i]].encodingOffset);
+            out << "};\n";
+            out << "        if (!IsConnected()) return;\n";
+            if (toCPP) out << "        const char* base = reinterpret_cast<const char*>(&GetData()->ToCPP);\n";
+            else out << "        char* base = reinterpret_cast<char*>(&GetData()->" << block << ");\n";
+
+            for (size_t start = 0; start < members.size();) {
+                size_t end = start + 1;
+                while (end < members.size()) {
+                    const FieldSlot& prev = layout.fields[members[end - 1]];
+                    const FieldSlot& next = layout.fields[members[end]];
+                    if (next.type != prev.type || next.offset != prev.offset + prev.size) break;
+                    end++;
+                }
+                const Variable& first = variables[members[start]];
+                std::string field = "base + offsetof(ST_" + block + ", " + first.name + ")";
+                std::string tables = std::to_string(end - start) + ", scale + " + std::to_string(start) +
+                                     ", offset + " + std::to_string(start);
+                if (toCPP) {
+                    out << "        BridgeEncoding::DecodeRun<" << first.encoding << ">(" << field << ", " << tables
+                        << ", values + " << start << ");\n";
+                } else {
+                    out << "        BridgeEncoding::EncodeRun<" << first.encoding << ">(values + " << start << ", " << tables
+                        << ", " << field << ");\n";
+                }
+                start = end;
+            }
+            out << "    }\n\n";
+        }
+    }
+
+    // Masked access to one packed bit, the rest of its word is left untouched
+    void generateBitAccessor(OutputBuffer& out, const Variable& bit) {
+        std::string word = bitWord(bit);
+        std::string mask = bitMask(bit);
+        if (bit.direction == "toCPP") {
+            out << "    BOOL Get" << capitalize(bit.name) << "() const {\n";
+            out << "        return IsConnected() && (GetData()->ToCPP." << word << " & " << mask << ") != 0;\n";
+            out << "    }\n\n";
+        } else {
+            out << "    void Set" << capitalize(bit.name) << "(BOOL value) {\n";
+            out << "        if (!IsConnected()) return;\n";
+            out << "        " << blockType(bit) << "& d = GetData()->" << blockOf(bit) << ";\n";
+            out << "        d." << word << " = value ? (d." << word << " | " << mask << ") : (d." << word << " & ~" << mask << ");\n";
+            out << "    }\n\n";
+        }
+    }
+
+    /**
+     * Word accessors of the packed bit groups
+     * ToCPP groups are copied out once and then counted or scanned with
+     * popcount/ctz over whole words (BridgeEncoding.hpp), so checking a few
+     * thousand inputs for changes costs a few dozen word compares.
+     */
+    void generateBitGroupAccessors(OutputBuffer& out, const std::string& writer) {
+        for (const auto& g : bitGroups) {
+            if (g.writer != writer) continue;
+            size_t words = (g.bits.size() + g.wordBits - 1) / g.wordBits;
+            bool toCPP = (g.direction == "toCPP");
+            const std::string block = blockOf(g.bits[0]);
+
+            out << "    // Bit group " << g.name << " (" << g.bits.size() << " BOOL in " << words << " " << g.wordType << ")\n";
+            out << "    static constexpr size_t " << g.name << "Count = " << g.bits.size() << ";\n";
+            out << "    static constexpr size_t " << g.name << "Words = " << words << ";\n";
+            out << "    enum " << g.name << "Bit : size_t {\n";
+            for (const auto& bit : g.bits) out << "        " << g.name << "_" << bit.name << " = " << bit.bitIndex << ",\n";
+            out << "    };\n\n";
+
+            if (toCPP) {
+                out << "    void Get" << g.name << "(" << g.wordType << "* words) const {\n";
+                out << "        if (!IsConnected()) return;\n";
+                out << "        const ST_ToCPP& d = GetData()->ToCPP;\n";
+                for (size_t w = 0; w < words; w++) out << "        words[" << w << "] = d." << bitWordName(g.name, w) << ";\n";
+                out << "    }\n\n";
+
+                out << "    size_t Count" << g.name << "() const {\n";
+                out << "        " << g.wordType << " words[" << g.name << "Words] = {};\n";
+                out << "        Get" << g.name << "(words);\n";
+                out << "        return BridgeEncoding::CountBits(words, " << g.name << "Words);\n";
+                out << "    }\n\n";
+
+                out << "    // f(bit) for every set bit, lowest first\n";
+                out << "    template<typename F>\n";
+                out << "    void ForEach" << g.name << "(F f) const {\n";
+                out << "        " << g.wordType << " words[" << g.name << "Words] = {};\n";
+                out << "        Get" << g.name << "(words);\n";
+                out << "        BridgeEncoding::ForEachSetBit(words, " << g.name << "Words, f);\n";
+                out << "    }\n\n";
+
+                out << "    // f(bit, value) for every bit that differs from 'previous' (updated), returns the count\n";
+                out << "    template<typename F>\n";
+                out << "    size_t ForEachChanged" << g.name << "(" << g.wordType << "* previous, F f) const {\n";
+                out << "        " << g.wordType << " words[" << g.name << "Words] = {};\n";
+                out << "        Get" << g.name << "(words);\n";
+                out << "        return BridgeEncoding::ForEachChangedBit(words, previous, " << g.name << "Words, f);\n";
+                out << "    }\n\n";
+            } else {
+                out << "    void Set" << g.name << "(const " << g.wordType << "* words) {\n";
+                out << "        if (!IsConnected()) return;\n";
+                out << "        ST_" << block << "& d = GetData()->" << block << ";\n";
+                for (size_t w = 0; w < words; w++) out << "        d." << bitWordName(g.name, w) << " = words[" << w << "];\n";
+                out << "    }\n\n";
+            }
+        }
+    }
+
+    // One sample of the ST_<Name>Stats variables in engineering units, either direction
+    void generateStatsAccessor(OutputBuffer& out) {
+        const Model& m = model();
+        if (m.stats.empty()) return;
+        out << "    // Statistics sample (ST_" << memoryName << "Stats::Names order)\n";
+        out << "    void GetStatsSample(LREAL* values) const {\n";
+        out << "        if (!IsConnected()) return;\n";
+        out << "        const ST_" << memoryName << "& d = *GetData();\n";
+        for (size_t n = 0; n < m.stats.size(); n++) {
+            const Variable& v = variables[m.stats[n]];
+            std::string field = "d." + blockOf(v) + "." + v.name;
+            out << "        values[" << n << "] = ";
+            if (!v.encoding.empty()) {
+                out << "BridgeEncoding::Dequantize<" << v.encoding << ">(" << field << ", " << literal(v.encodingScale)
+                    << ", " << literal(v.encodingOffset) << ");\n";
+            } else {
+                out << "static_cast<LREAL>(" << field << ");\n";
+            }
+        }
+        out << "    }\n\n";
+    }
+
+    // Shortest decimal literal that reads back as the same double
+    static std::string literal(double value) {
+        std::ostringstream text;
+        for (int precision = 6; precision <= 17; precision++) {
+            text.str("");
+            text << std::setprecision(precision) << value;
+            if (std::stod(text.str()) == value) break;
+        }
+        return text.str();
+    }
+
+    // 4. Generate Webots Controller
     void generateWebotsController(const std::string& outputPath) {
-        std::ofstream out(outputPath);
-        
-        std::string lowerName = memoryName;
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+        const Model& m = model();
+        const std::string& lowerName = m.lowerName;
+        OutputBuffer out(outputPath, 2048 + variables.size() * 220);
+
+        // One device per (type, name), enabled at the fastest period of its variables
+        struct Device { std::string type, name, ident; int period; };
+        std::vector<Device> devices;
+        std::map<std::string, size_t> deviceIndex;
+        std::map<const Variable*, size_t> deviceOf;
+        std::map<int, std::vector<const Variable*>> readsByPeriod;
+        std::set<std::string> classes;
+        std::vector<const Variable*> inputs;
+        for (size_t i : m.fromCPP) inputs.push_back(&variables[i]);
+        for (const auto& w : m.writers) {
+            for (size_t i : w.fields) inputs.push_back(&variables[i]);
+        }
+        for (const auto& g : bitGroups) {
+            if (g.direction != "fromCPP") continue;
+            for (const auto& bit : g.bits) inputs.push_back(&bit);
+        }
+        for (const Variable* input : inputs) {
+            const Variable& v = *input;
+            if (v.deviceType.empty()) continue;
+            auto it = deviceIndex.insert(std::make_pair(v.deviceType + "|" + v.deviceName, devices.size())).first;
+            if (it->second == devices.size()) {
+                devices.push_back({v.deviceType, v.deviceName, deviceIdent(v.deviceType, v.deviceName), v.devicePeriod});
+            } else {
+                int& period = devices[it->second].period;
+                if (period != 0 && (v.devicePeriod == 0 || v.devicePeriod < period)) period = v.devicePeriod;
+            }
+            deviceOf[input] = it->second;
+            readsByPeriod[v.devicePeriod].push_back(input);
+            classes.insert(deviceClass(v.deviceType));
+        }
+        for (size_t i : m.physics) {
+            if (variables[i].direction == "fromCPP") classes.insert("PositionSensor");
+        }
+        bool ticks = !readsByPeriod.empty() && readsByPeriod.rbegin()->first > 0;
 
         out << "// Auto-generated Webots controller for: " << memoryName << "\n\n";
         out << "#include <webots/Robot.hpp>\n";
         out << "#include <webots/Motor.hpp>\n";
-        out << "#include <webots/PositionSensor.hpp>\n";
+        for (const auto& c : classes) {
+            if (c != "Motor") out << "#include <webots/" << c << ".hpp>\n";
+        }
+        out << "#include <algorithm>\n";
+        if (!m.physics.empty()) out << "#include <cmath>\n";
         out << "#include <iostream>\n";
-        out << "#include \"" << lowerName << "_client.hpp\"\n\n";
+        out << "#include \"" << lowerName << "_client.hpp\"\n";
+        if (lockstep) out << "#include \"Lockstep.hpp\"\n";
+        if (!m.stats.empty()) out << "#include \"BridgeStats.hpp\"\n";
+        out << "\n";
         out << "using namespace webots;\n";
         out << "using namespace std;\n\n";
-        out << "#define TIME_STEP 64\n\n";
         out << "int main(int argc, char **argv) {\n";
         out << "    Robot *robot = new Robot();\n";
+        if (timeStep > 0) {
+            out << "    const int TIME_STEP = " << timeStep << ";\n";
+        } else {
+            out << "    const int TIME_STEP = std::max(1, static_cast<int>(robot->getBasicTimeStep()));\n";
+        }
         out << "    " << memoryName << "Client client;\n\n";
+        const bool partitioned = !m.writers.empty();
+        if (partitioned) {
+            out << "    // Blocks published by this controller (controllerArgs): FromCPP (with LifeCPP, lockstep,\n";
+            out << "    // episode resets and statistics) and/or writer partitions; none = all of them\n";
+            out << "    const vector<string> blocks(argv + 1, argv + argc);\n";
+            out << "    auto publishes = [&](const char* block) {\n";
+            out << "        return blocks.empty() || std::find(blocks.begin(), blocks.end(), block) != blocks.end();\n";
+            out << "    };\n";
+            out << "    for (const string& block : blocks) {\n";
+            out << "        if (block != \"FromCPP\"";
+            for (const auto& w : m.writers) out << " && block != \"" << w.name << "\"";
+            out << ") {\n";
+            out << "            cerr << \"Unknown block: \" << block << \" (FromCPP";
+            for (const auto& w : m.writers) out << ", " << w.name;
+            out << ")\" << endl;\n";
+            out << "            delete robot;\n";
+            out << "            return 1;\n";
+            out << "        }\n";
+            out << "    }\n";
+            out << "    const bool wholeSegment = publishes(\"FromCPP\");\n";
+            for (const auto& w : m.writers) out << "    " << memoryName << w.name << "Writer writer" << w.name << ";\n";
+            out << "    // A partition controller only reads the commands, LifeCPP stays with the whole-segment controller\n";
+            out << "    if (!wholeSegment) client.SetReadOnly(true);\n\n";
+        }
         out << "    cout << \"=== " << memoryName << " Webots Controller ===\" << endl;\n\n";
 
-        out << "    // Get motors and sensors\n";
-        for (const auto& v : variables) {
-            if (v.direction == "toCPP" && v.type != "STRING") {
+        if (!m.physics.empty()) {
+            out << "    // Joints declared with \"physics\" are exchanged by " << lowerName << "_physics every physics step,\n";
+            out << "    // or here when the plugin cannot attach (UDP transport)\n";
+        }
+        out << "    // Get motors\n";
+        for (size_t i : m.toCPP) {
+            const Variable& v = variables[i];
+            if (v.type != "STRING" && !isBitWord(v)) {
                 out << "    Motor *" << v.name << "_motor = robot->getMotor(\"" << v.name << "\");\n";
             }
-            // Assume fromCPP LREAL variables with "sensor" in name are PositionSensors
-            if (v.direction == "fromCPP" && v.type == "LREAL") {
-                std::string sensorName = v.name;
-                // Simple heuristic: map variable name to device name
-                out << "    PositionSensor *" << v.name << " = robot->getPositionSensor(\"" << sensorName << "\");\n";
-                out << "    if (" << v.name << ") " << v.name << "->enable(TIME_STEP);\n";
-            }
+        }
+
+        out << "\n    // Get sensors, each computed by Webots only at its own sampling period\n";
+        for (const auto& d : devices) {
+            std::string period = d.period > 0 ? std::to_string(d.period) : "TIME_STEP";
+            out << "    " << deviceClass(d.type) << " *" << d.ident << " = robot->get" << deviceClass(d.type)
+                << "(\"" << d.name << "\");\n";
+            out << "    if (" << d.ident << ") " << d.ident << "->"
+                << (d.type == "TorqueFeedback" ? "enableTorqueFeedback(" : "enable(") << period << ");\n";
+        }
+        for (size_t i : m.physics) {
+            const Variable& v = variables[i];
+            if (v.direction != "fromCPP") continue;
+            out << "    PositionSensor *physics_" << v.name << " = robot->getPositionSensor(\"" << v.name << "\");   // UDP fallback\n";
         }
         out << "\n";
 
         out << "    // Connect to CODESYS\n";
         out << "    while (!client.Connect(L\"OKZiJMksN52vWF53\")) {\n";
+        out << "        if (client.GetStatus() == GenericSharedMemory::LAYOUT_MISMATCH) {\n";
+        out << "            cerr << \"Segment layout does not match " << memoryName << ", regenerate the controller\" << endl;\n";
+        out << "            delete robot;\n";
+        out << "            return 1;\n";
+        out << "        }\n";
         out << "        cout << \"Waiting for CODESYS...\" << endl;\n";
         out << "        robot->step(TIME_STEP);\n";
         out << "    }\n";
-        out << "    cout << \">> Connected!\" << endl;\n\n";
-
-        out << "    // Main loop\n";
-        out << "    while (robot->step(TIME_STEP) != -1) {\n";
-        
-        out << "        // Write commands (PLC -> Webots)\n";
-        for (const auto& v : variables) {
-            if (v.direction == "toCPP" && v.type != "STRING") {
-                std::string capitalized = v.name;
-                capitalized[0] = toupper(capitalized[0]);
-                out << "        if (" << v.name << "_motor) " << v.name << "_motor->setPosition(client.Get" << capitalized << "());\n";
+        out << "    cout << \">> Connected!\" << endl;\n";
+        out << "    uint32_t generation = client.GetGeneration();\n\n";
+        if (!m.physics.empty()) {
+            out << "    // " << lowerName << "_physics only attaches to local shared memory\n";
+            out << "    const bool physicsPlugin = client.GetTransport() == nullptr;\n";
+            out << "    if (!physicsPlugin) {\n";
+            out << "        cout << \">> Physics joints exchanged by the controller over UDP\" << endl;\n";
+            for (size_t i : m.physics) {
+                const Variable& v = variables[i];
+                if (v.direction == "fromCPP") out << "        if (physics_" << v.name << ") physics_" << v.name << "->enable(TIME_STEP);\n";
+            }
+            out << "    }\n";
+            for (size_t i : m.physics) {
+                const Variable& v = variables[i];
+                if (v.direction == "fromCPP" && v.physicsValue == "velocity") out << "    double " << v.name << "_last = NAN;\n";
+            }
+            out << "\n";
+        }
+        if (partitioned) {
+            out << "    // Writer partitions of this controller, each with its own heartbeat; over UDP they are\n";
+            out << "    // written into the client's frames (partition-only controllers need local shared memory)\n";
+            for (const auto& w : m.writers) {
+                out << "    if (publishes(\"" << w.name << "\") && !(client.GetTransport() ? writer" << w.name << ".Share(client) : writer"
+                    << w.name << ".Connect(L\"OKZiJMksN52vWF53\"))) {\n";
+                out << "        cerr << \"Partition " << w.name << " unavailable\" << endl;\n";
+                out << "    }\n";
             }
+            out << "\n";
         }
 
-        out << "\n        // Read sensors (Webots -> PLC)\n";
-        for (const auto& v : variables) {
-             if (v.direction == "fromCPP" && v.type == "LREAL") {
-                std::string capitalized = v.name;
-                capitalized[0] = toupper(capitalized[0]);
-                out << "        if (" << v.name << ") client.Set" << capitalized << "(" << v.name << "->getValue());\n";
+        const std::string statsType = "ST_" + memoryName + "Stats";
+        if (!m.stats.empty()) {
+            out << "    // Windowed statistics for monitors, published into their own segment\n";
+            out << "    BridgeStats::Publisher<" << statsType << "> stats(" << statsWindowMs << ");\n";
+            out << "    if (" << (partitioned ? "wholeSegment && " : "") << "!stats.Create(L\"OKZiJMksN52vWF53_stats\")) cerr << \"Statistics segment unavailable\" << endl;\n";
+            out << "    LREAL statsSample[" << statsType << "::Count];\n\n";
+        }
+        auto addStats = [&]() {
+            if (m.stats.empty()) return;
+            out << "        client.GetStatsSample(statsSample);\n";
+            out << "        stats.Add(statsSample, robot->getTime() * 1000.0);\n";
+        };
+
+        out << "    // Episode start: restored when a supervisor resets the simulation. Sensors read every\n";
+        out << "    // cycle overwrite their FromCPP fields the same step, so only fields sampled at a longer\n";
+        out << "    // device period (until their next sample) and fields without a device keep the checkpoint\n";
+        out << "    std::unique_ptr<" << memoryName << "Client::Checkpoint> episodeStart(new " << memoryName << "Client::Checkpoint());\n";
+        out << "    bool checkpointSaved = false;\n";
+        out << "    for (int attempt = 0; attempt < 10 && !checkpointSaved; attempt++) checkpointSaved = client.SaveCheckpoint(*episodeStart);\n";
+        out << "    if (!checkpointSaved) cerr << \"Episode checkpoint unavailable (LifePLC kept changing), resets keep the current outputs\" << endl;\n";
+        out << "    double lastTime = robot->getTime();\n\n";
+        auto episodeReset = [&]() {
+            out << "        // Reset hook: simulationReset() sends the simulation time back\n";
+            out << "        if (robot->getTime() < lastTime) {\n";
+            out << "            " << (partitioned ? "if (wholeSegment) " : "") << "client.RestoreCheckpoint(*episodeStart);\n";
+            for (const auto& w : m.writers) {
+                out << "            if (writer" << w.name << ".IsConnected()) writer" << w.name << ".RestoreCheckpoint(*episodeStart);\n";
+            }
+            for (size_t i : m.physics) {
+                const Variable& v = variables[i];
+                if (v.direction == "fromCPP" && v.physicsValue == "velocity") out << "            " << v.name << "_last = NAN;\n";
+            }
+            if (ticks) out << "            elapsedMs = 0;\n";
+            out << "            episodes++;\n";
+            out << "        }\n";
+            out << "        lastTime = robot->getTime();\n";
+        };
+
+        auto writeCommands = [&]() {
+            out << "        // Write commands (PLC -> Webots)\n";
+            for (size_t i : m.toCPP) {
+                const Variable& v = variables[i];
+                if (v.type == "STRING" || isBitWord(v)) continue;
+                if (v.physicsBody.empty()) {
+                    out << "        if (" << v.name << "_motor) " << v.name << "_motor->setPosition(client.Get" << m.capitalized[i] << "());\n";
+                } else if (v.physicsValue == "velocity") {
+                    out << "        if (!physicsPlugin && " << v.name << "_motor) {\n";
+                    out << "            " << v.name << "_motor->setPosition(INFINITY);\n";
+                    out << "            " << v.name << "_motor->setVelocity(client.Get" << m.capitalized[i] << "());\n";
+                    out << "        }\n";
+                } else {
+                    out << "        if (!physicsPlugin && " << v.name << "_motor) " << v.name << "_motor->setPosition(client.Get" << m.capitalized[i] << "());\n";
+                }
             }
+        };
+        auto readSensors = [&]() {
+            out << "\n        // Read sensors on their sample ticks (Webots -> PLC)\n";
+            for (const auto& w : m.writers) out << "        writer" << w.name << ".BeginUpdate();\n";
+            for (const auto& entry : readsByPeriod) {
+                std::string indent = "        ";
+                if (entry.first > 0) {
+                    out << "        if (elapsedMs % " << entry.first << " < TIME_STEP) {\n";
+                    indent += "    ";
+                }
+                for (const Variable* input : entry.second) {
+                    const Variable& v = *input;
+                    const std::string& ident = devices[deviceOf[input]].ident;
+                    std::string value = ident + "->" + deviceRead(v);
+                    if (v.type == "BOOL") value += " > 0.0";
+                    else if (v.type != "LREAL" && v.type != "REAL") value = "static_cast<" + v.type + ">(" + value + ")";
+                    if (!v.writer.empty()) {
+                        out << indent << "if (" << ident << ") writer" << v.writer << ".Set" << capitalize(v.name) << "(" << value << ");\n";
+                    } else {
+                        out << indent << "if (" << (partitioned ? "wholeSegment && " : "") << ident << ") client.Set"
+                            << capitalize(v.name) << "(" << value << ");\n";
+                    }
+                }
+                if (entry.first > 0) out << "        }\n";
+            }
+            for (const auto& w : m.writers) out << "        writer" << w.name << ".EndUpdate();\n";
+            for (size_t i : m.physics) {
+                const Variable& v = variables[i];
+                if (v.direction != "fromCPP") continue;
+                std::string guard = std::string("!physicsPlugin && ") + (partitioned ? "wholeSegment && " : "") + "physics_" + v.name;
+                if (v.physicsValue == "velocity") {
+                    out << "        if (" << guard << ") {\n";
+                    out << "            double position = physics_" << v.name << "->getValue();\n";
+                    out << "            if (!std::isnan(" << v.name << "_last)) client.Set" << m.capitalized[i] << "((position - " << v.name << "_last) * 1000.0 / TIME_STEP);\n";
+                    out << "            " << v.name << "_last = position;\n";
+                    out << "        }\n";
+                } else {
+                    out << "        if (" << guard << ") client.Set" << m.capitalized[i] << "(physics_" << v.name << "->getValue());\n";
+                }
+            }
+        };
+        auto sync = [&]() {
+            // Partition heartbeats first, a shared mapping sends them with the client's frame
+            for (const auto& w : m.writers) out << "        writer" << w.name << ".Sync();\n";
+            out << "        client.Sync();\n";
+        };
+
+        if (lockstep) {
+            out << "    // Lockstep: the PLC completes one cycle per simulation step (see Lockstep.hpp)\n";
+            out << "    // The handshake is not relayed over UDP, split-host runs stay free-running\n";
+            if (partitioned) {
+                out << "    // Partition controllers free-run, the whole-segment controller holds the handshake\n";
+                out << "    const bool lockstepActive = wholeSegment && client.GetTransport() == nullptr;\n";
+                out << "    if (wholeSegment && !lockstepActive) cout << \">> Lockstep needs shared memory, free-running over UDP\" << endl;\n";
+            } else {
+                out << "    const bool lockstepActive = client.GetTransport() == nullptr;\n";
+                out << "    if (!lockstepActive) cout << \">> Lockstep needs shared memory, free-running over UDP\" << endl;\n";
+            }
+            out << "    auto armLockstep = [&]() {\n";
+            out << "        if (!lockstepActive) return;\n";
+            out << "        client->Lockstep.StepMs = TIME_STEP;\n";
+            out << "        client->Lockstep.SimDone = Lockstep::Load(&client->Lockstep.PlcDone);\n";
+            out << "        Lockstep::Publish(&client->Lockstep.Enable, 1);\n";
+            out << "    };\n";
+            out << "    armLockstep();\n\n";
         }
 
-        out << "        client.Sync();\n";
+        out << "    // Main loop\n";
+        out << "    long long episodes = 1;\n";
+        if (ticks) out << "    long long elapsedMs = 0;\n";
+        if (lockstep) {
+            out << "    while (true) {\n";
+            out << "        // Wait for the PLC cycle of this step, following PLC restarts meanwhile\n";
+            out << "        while (lockstepActive && !Lockstep::WaitUntil(&client->Lockstep.PlcDone, client->Lockstep.SimDone + 1, 20)) {\n";
+            out << "            client.Sync();\n";
+            out << "            if (!client.IsConnected()) break;\n";
+            out << "            if (client.GetGeneration() != generation) {\n";
+            out << "                generation = client.GetGeneration();\n";
+            out << "                cout << \">> PLC restarted, segment generation \" << client.GetHeaderGeneration() << endl;\n";
+            out << "                armLockstep();\n";
+            out << "            }\n";
+            out << "        }\n";
+            out << "        if (!client.IsConnected()) {\n";
+            out << "            cerr << \"PLC switched to a different segment layout, regenerate the controller\" << endl;\n";
+            out << "            break;\n";
+            out << "        }\n\n";
+            writeCommands();
+            out << "\n        if (robot->step(TIME_STEP) == -1) break;\n";
+            episodeReset();
+            if (ticks) out << "        elapsedMs += TIME_STEP;\n";
+            readSensors();
+            sync();
+            addStats();
+            out << "        if (lockstepActive) Lockstep::Publish(&client->Lockstep.SimDone, client->Lockstep.SimDone + 1);\n\n";
+        } else {
+            out << "    while (robot->step(TIME_STEP) != -1) {\n";
+            episodeReset();
+            if (ticks) out << "        elapsedMs += TIME_STEP;\n";
+            out << "\n";
+            writeCommands();
+            readSensors();
+            sync();
+            addStats();
+            out << "\n";
+        }
+
+        out << "        // PLC restarts are followed inside Sync(), only a new layout ends the controller\n";
+        out << "        if (client.GetStatus() == GenericSharedMemory::LAYOUT_MISMATCH) {\n";
+        out << "            cerr << \"PLC switched to a different segment layout, regenerate the controller\" << endl;\n";
+        out << "            break;\n";
+        out << "        }\n";
+        out << "        if (client.GetGeneration() != generation) {\n";
+        out << "            if (generation != 0) cout << \">> PLC restarted, segment generation \" << client.GetHeaderGeneration() << endl;\n";
+        out << "            generation = client.GetGeneration();\n";
+        if (lockstep) out << "            armLockstep();\n";
+        out << "        }\n";
         out << "    }\n\n";
+        if (lockstep) out << "    if (lockstepActive && client.IsConnected()) Lockstep::Publish(&client->Lockstep.Enable, 0);\n";
+        out << "    if (episodes > 1) cout << \"Episodes: \" << episodes << endl;\n";
         out << "    delete robot;\n";
         out << "    return 0;\n";
         out << "}\n";
     }
 
+    // C++ identifier of a device pointer: "gps_front_gps", "ps_elbow_joint"
+    static std::string deviceIdent(const std::string& type, const std::string& name) {
+        std::string prefix = type == "PositionSensor" ? "ps" : type == "TouchSensor" ? "touch" :
+                             type == "InertialUnit" ? "imu" : type == "GPS" ? "gps" :
+                             type == "DistanceSensor" ? "ds" : "torque";
+        std::string ident = prefix + "_";
+        for (char c : name) ident += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        return ident;
+    }
+
     // 5. Generate Usage README
     void generateReadme(const std::string& outputPath) {
-        std::ofstream out(outputPath);
-        
-        std::string lowerName = memoryName;
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+        const std::string& lowerName = model().lowerName;
+        OutputBuffer out(outputPath, 4096 + variables.size() * 64);
 
         out << "# " << memoryName << " - Generated Integration\n\n";
         out << "Auto-generated from JSON schema by Program12 Unified Generator\n\n";
@@ -440,8 +1940,10 @@ public:
         out << "   VAR\n";
         out << "       data : ST_" << memoryName << ";\n";
         out << "       fbShm : FB_GenericSharedMem;\n";
+        out << "       fbGeneration : FB_" << memoryName << "Generation;\n";
         out << "   END_VAR\n";
         out << "   \n";
+        out << "   fbGeneration(Header := data.Header);\n";
         out << "   fbShm(\n";
         out << "       pData := ADR(data),\n";
         out << "       DataSize := SIZEOF(ST_" << memoryName << "),\n";
@@ -449,6 +1951,23 @@ public:
         out << "       Enable := TRUE\n";
         out << "   );\n";
         out << "   ```\n\n";
+        out << "3. **Segment header:** `data.Header` is initialized with the layout fingerprint (16#"
+            << hex32(model().layoutHash) << ") and must stay the first member. Controllers refuse a segment with another ";
+        out << "fingerprint and remap by themselves when `Header.Generation` changes. `FB_" << memoryName << "Generation` ";
+        out << "(imported with the types) writes a new value once per PLC start; call it before `fbShm` as above.\n\n";
+        if (lockstep) {
+            out << "4. **Lockstep:** the controller sets `data.Lockstep.Enable` and expects exactly one PLC cycle per simulation step. ";
+            out << "Wrap the cyclic program in the handshake and advance simulated time by `StepMs` instead of the task clock:\n";
+            out << "   ```structured-text\n";
+            out << "   IF data.Lockstep.Enable = 0 OR data.Lockstep.SimDone = data.Lockstep.PlcDone THEN\n";
+            out << "       // ... program cycle, simulated time advances by data.Lockstep.StepMs ...\n";
+            out << "       data.LifePLC := data.LifePLC + 1;\n";
+            out << "       IF data.Lockstep.Enable <> 0 THEN\n";
+            out << "           data.Lockstep.PlcDone := data.Lockstep.PlcDone + 1;\n";
+            out << "       END_IF\n";
+            out << "   END_IF\n";
+            out << "   ```\n\n";
+        }
         
         out << "## C++ Client Setup\n\n";
         out << "1. **Include files:**\n";
@@ -472,23 +1991,970 @@ public:
         out << "   - `cpp/" << lowerName << "_types.hpp`\n";
         out << "   - `cpp/" << lowerName << "_client.hpp`\n";
         out << "   - `GenericSharedMemory.hpp`\n";
+        out << "   - `BridgeEncoding.hpp`\n";
+        if (lockstep) out << "   - `Lockstep.hpp`\n";
         out << "   - `CodesysTypes.hpp`\n\n";
         out << "3. **Compile** and set as robot controller\n\n";
+        if (!model().physics.empty()) {
+            out << "4. **Physics plugin:** build `webots/" << lowerName << "_physics.cpp` with the same headers as\n";
+            out << "   `<webots_project>/plugins/physics/" << lowerName << "_physics/` and set `WorldInfo.physics` to `\""
+                << lowerName << "_physics\"`.\n";
+            out << "   It exchanges the joints marked *physics* below every physics step; the controller leaves them alone.\n\n";
+        }
+
+        if (!model().writers.empty()) {
+            const Model& m = model();
+            out << "## Writer Partitions\n\n";
+            out << "The fields marked *written by* below live in `data.FromCPP_<Writer>`, each on cache lines of its own with a ";
+            out << "`Seq` (odd while the writer updates the block) and a `Life` heartbeat. Start one controller per writer ";
+            out << "with the writer as its `controllerArgs`:\n\n";
+            out << "| Writer | Controller argument | C++ class | Offset | Fields |\n";
+            out << "|--------|---------------------|-----------|--------|--------|\n";
+            for (size_t w = 0; w < m.writers.size(); w++) {
+                out << "| " << m.writers[w].name << " | `" << m.writers[w].name << "` | `" << memoryName << m.writers[w].name
+                    << "Writer` | " << m.layout.partitions[w].offset << " | " << m.writers[w].fields.size() << " |\n";
+            }
+            out << "\nThe arguments list the blocks a controller publishes, `FromCPP` standing for the shared block with `LifeCPP`, ";
+            out << "the lockstep handshake, episode resets and statistics; without arguments it publishes all of them. Next to ";
+            out << "partition controllers, start the whole-segment controller with `FromCPP` only, so no block has two writers. ";
+            out << "A controller without `FromCPP` attaches read-only for the commands and needs local shared memory; over UDP ";
+            out << "a single controller writes its partitions into its own frames. In the PLC, check each writer's `Life` for liveness and copy a partition while its `Seq` is even and unchanged:\n";
+            out << "```structured-text\n";
+            out << "seq := data.FromCPP_" << m.writers[0].name << ".Seq;\n";
+            out << "IF (seq MOD 2) = 0 THEN\n";
+            out << "    copy := data.FromCPP_" << m.writers[0].name << ";\n";
+            out << "    valid := copy.Seq = seq AND data.FromCPP_" << m.writers[0].name << ".Seq = seq;\n";
+            out << "END_IF\n";
+            out << "```\n\n";
+        }
+
+        out << "## Split-Host Deployment (UDP)\n\n";
+        out << "Run Webots on a different machine than the PLC without regenerating:\n\n";
+        out << "1. **PLC host:** build and start `webots/" << lowerName << "_udp_relay.cpp`\n";
+        out << "   ```\n";
+        out << "   " << lowerName << "_udp_relay udp://<sim-host>:47000?bind=47001\n";
+        out << "   ```\n";
+        out << "2. **Simulation host:** set the transport for the controller\n";
+        out << "   ```\n";
+        out << "   CODESYS_BRIDGE_TRANSPORT=udp://<plc-host>:47001?bind=47000\n";
+        out << "   ```\n";
+        out << "   (add it to `runtime.ini` under `[environment variables]`)\n\n";
+        out << "Options: `delta=0` disables delta frames, `mtu=<bytes>` sets the datagram size.\n\n";
+
+        out << "## C ABI Library\n\n";
+        out << "For non-C++ tooling, build `webots/" << lowerName << "_bridge_capi.cpp` as a shared library:\n\n";
+        out << "```\n";
+        out << "g++ -std=c++17 -O2 -shared -fPIC -fvisibility=hidden -DBRIDGE_CAPI_BUILD " << lowerName << "_bridge_capi.cpp -o lib"
+            << lowerName << "bridge.so\n";
+        out << "```\n\n";
+        out << "See `BridgeCApi.h`: `bridge_fields()` lists name, type, offset and size of every field, ";
+        out << "`bridge_view()` returns zero-copy pointers and strides for runs of equally typed fields.\n\n";
+
+        if (!model().stats.empty()) {
+            out << "## Statistics Segment\n\n";
+            out << "The controller publishes min/max/mean/RMS of " << model().stats.size() << " variables every "
+                << statsWindowMs << " ms (simulation time) into `OKZiJMksN52vWF53_stats`. Monitors attach read-only:\n\n";
+            out << "```cpp\n";
+            out << "#include \"" << model().lowerName << "_types.hpp\"\n";
+            out << "#include \"BridgeStats.hpp\"\n\n";
+            out << "BridgeStats::Reader<ST_" << memoryName << "Stats> stats;\n";
+            out << "stats.Connect(L\"OKZiJMksN52vWF53_stats\");\n";
+            out << "ST_" << memoryName << "Stats window;\n";
+            out << "if (stats.Read(window)) { /* window.Fields[i] belongs to window.Names[i] */ }\n";
+            out << "```\n\n";
+        }
         
         out << "## Schema Variables\n\n";
         out << "| Name | Type | Direction | Purpose |\n";
         out << "|------|------|-----------|----------|\n";
-        for (const auto& v : variables) {
+        auto row = [&](const Variable& v) {
             std::string typeStr = v.type;
             if (v.type == "STRING") typeStr += "[" + std::to_string(v.size) + "]";
+            if (!v.encoding.empty()) typeStr += " as " + v.encoding + " (" + encodingRule(v) + ")";
+            if (isBitWord(v)) typeStr += " (bit group " + v.bitGroup + ")";
+            else if (!v.bitGroup.empty()) typeStr += " in " + bitWord(v) + "." + std::to_string(v.bitIndex % findBitGroup(v.bitGroup).wordBits);
             out << "| " << v.name << " | " << typeStr << " | " << v.direction << " | ";
-            out << (v.direction == "toCPP" ? "PLC → C++" : "C++ → PLC") << " |\n";
+            out << (v.direction == "toCPP" ? "PLC → C++" : "C++ → PLC");
+            if (!v.writer.empty()) out << " written by " << v.writer;
+            if (!v.physicsBody.empty()) {
+                out << (v.direction == "toCPP" ? " to" : " from") << " physics `" << v.physicsBody << "` (" << v.physicsValue << ")";
+            }
+            if (!v.deviceType.empty()) {
+                out << " from " << v.deviceType << " `" << v.deviceName << "`";
+                if (v.deviceType == "GPS" || v.deviceType == "InertialUnit") out << "[" << v.deviceIndex << "]";
+                if (v.devicePeriod > 0) out << " every " << v.devicePeriod << " ms";
+            }
+            out << " |\n";
+        };
+        for (const auto& v : variables) {
+            row(v);
+            if (!isBitWord(v)) continue;
+            const BitGroup& g = findBitGroup(v.bitGroup);
+            size_t first = v.bitIndex * g.wordBits;
+            for (size_t b = first; b < std::min(g.bits.size(), first + g.wordBits); b++) row(g.bits[b]);
         }
         
         out << "\n## UUIDs (for reference)\n\n";
         out << "- ST_" << memoryName << ": `" << uuidMain << "`\n";
         out << "- ST_ToCPP: `" << uuidToCPP << "`\n";
         out << "- ST_FromCPP: `" << uuidFromCPP << "`\n";
+        for (const auto& w : model().writers) out << "- ST_FromCPP_" << w.name << ": `" << uuidWriters[w.name] << "`\n";
+    }
+
+    // 6. Generate UDP Relay (runs on the PLC host for split-host deployments)
+    void generateUdpRelay(const std::string& outputPath) {
+        const std::string& lowerName = model().lowerName;
+        OutputBuffer out(outputPath);
+
+        out << "// Auto-generated UDP relay for: " << memoryName << "\n";
+        out << "// Runs next to the CODESYS runtime and forwards the segment to a\n";
+        out << "// simulation host whose controller uses CODESYS_BRIDGE_TRANSPORT=udp://...\n\n";
+        out << "#include \"GenericSharedMemory.hpp\"\n";
+        out << "#include \"" << lowerName << "_types.hpp\"\n";
+        out << "#include <chrono>\n";
+        out << "#include <iostream>\n";
+        out << "#include <thread>\n\n";
+        out << "using namespace std;\n\n";
+        out << "int main(int argc, char **argv) {\n";
+        out << "    if (argc < 2) {\n";
+        out << "        cerr << \"Usage: " << lowerName << "_udp_relay udp://<sim-host>:<port>?bind=<port> [poll-us]\" << endl;\n";
+        out << "        return 1;\n";
+        out << "    }\n\n";
+        out << "    UdpTransport::Config cfg;\n";
+        out << "    if (!UdpTransport::ParseUri(argv[1], cfg)) {\n";
+        out << "        cerr << \"Invalid transport URI: \" << argv[1] << endl;\n";
+        out << "        return 1;\n";
+        out << "    }\n";
+        out << "    int pollUs = argc > 2 ? atoi(argv[2]) : 200;\n\n";
+        out << "    TypedSharedMemory<ST_" << memoryName << "> shm;\n";
+        out << "    shm.SetTransport(\"shm\");\n";
+        out << "    while (!shm.Connect(L\"OKZiJMksN52vWF53\")) {\n";
+        out << "        cout << \"Waiting for CODESYS...\" << endl;\n";
+        out << "        this_thread::sleep_for(chrono::milliseconds(500));\n";
+        out << "    }\n\n";
+        out << "    const size_t split = offsetof(ST_" << memoryName << ", FromCPP);\n";
+        out << "    const size_t life = offsetof(ST_" << memoryName << ", LifePLC);\n";
+        out << "    UdpTransport udp;\n";
+        out << "    if (!udp.Open(cfg,\n";
+        out << "                  UdpTransport::RangesFor(UdpTransport::ROLE_PLC, split, life),\n";
+        out << "                  UdpTransport::RangesFor(UdpTransport::ROLE_CPP, split, life))) {\n";
+        out << "        cerr << \"Cannot open UDP transport\" << endl;\n";
+        out << "        return 1;\n";
+        out << "    }\n";
+        out << "    cout << \">> Relaying " << memoryName << " to \" << cfg.remoteHost << \":\" << cfg.remotePort << endl;\n\n";
+        out << "    DINT lastLife = shm->LifePLC;\n";
+        out << "    auto lastSend = chrono::steady_clock::now();\n";
+        out << "    auto lastReport = lastSend;\n";
+        out << "    while (true) {\n";
+        out << "        udp.Receive(shm.GetPointer());\n\n";
+        out << "        // Forward on every PLC cycle, keep-alive every 10 ms\n";
+        out << "        auto now = chrono::steady_clock::now();\n";
+        out << "        if (shm->LifePLC != lastLife || now - lastSend > chrono::milliseconds(10)) {\n";
+        out << "            lastLife = shm->LifePLC;\n";
+        out << "            udp.Send(shm.GetPointer());\n";
+        out << "            lastSend = now;\n";
+        out << "        }\n\n";
+        out << "        if (now - lastReport > chrono::seconds(5)) {\n";
+        out << "            const UdpTransport::Stats& st = udp.GetStats();\n";
+        out << "            cout << \"sent \" << st.framesSent << \" (\" << st.deltaFrames << \" delta) recv \" << st.framesReceived\n";
+        out << "                 << \" lost \" << st.framesLost << \" dropped \" << st.framesDropped\n";
+        out << "                 << \" peer restarts \" << st.peerRestarts << endl;\n";
+        out << "            lastReport = now;\n";
+        out << "        }\n";
+        out << "        this_thread::sleep_for(chrono::microseconds(pollUs));\n";
+        out << "    }\n";
+        out << "}\n";
+    }
+
+    // 7. Generate Layout Report (size, padding and cache lines before/after optimization)
+    void generateLayoutReport(const std::string& outputPath, const SegmentLayout& before, const SegmentLayout& after) {
+        std::ostringstream summary;
+        summary << "Layout report for " << memoryName << " (" << layoutMode << ")\n\n";
+        summary << std::left << std::setw(28) << "" << std::setw(12) << "before" << "after\n";
+        summary << std::setw(28) << "Segment size (bytes)" << std::setw(12) << before.totalSize << after.totalSize << "\n";
+        summary << std::setw(28) << "Padding (bytes)" << std::setw(12) << before.padding << after.padding << "\n";
+        summary << std::setw(28) << "Misaligned fields" << std::setw(12) << misalignedFields(before) << misalignedFields(after) << "\n";
+        summary << std::setw(28) << "Cache lines per cycle" << std::setw(12) << cacheLinesPerCycle(before) << cacheLinesPerCycle(after) << "\n\n";
+
+        OutputBuffer out(outputPath, 1024 + after.fields.size() * 48);
+        out << summary.str();
+
+        std::vector<size_t> ordered(after.fields.size());
+        for (size_t i = 0; i < ordered.size(); i++) ordered[i] = i;
+        std::stable_sort(ordered.begin(), ordered.end(), [&](size_t a, size_t b) {
+            return after.fields[a].offset < after.fields[b].offset;
+        });
+
+        out << "Field order after optimization:\n";
+        char line[64];
+        for (size_t i : ordered) {
+            const FieldSlot& f = after.fields[i];
+            std::snprintf(line, sizeof(line), "  %8zu  %-8s%-8s%s", f.offset, f.direction.c_str(), f.type.c_str(),
+                          f.hot ? "hot  " : "     ");
+            out << line << f.name << "\n";
+        }
+    }
+
+    // 8. Generate Client Microbenchmark (hot paths against an in-process mapping)
+    void generateBenchmark(const std::string& outputPath) {
+        const Model& m = model();
+        const std::string& lowerName = m.lowerName;
+        const std::string clientName = memoryName + "Client";
+        OutputBuffer out(outputPath, 4096 + variables.size() * 48);
+
+        // Accessors are split into chunks to keep functions a reasonable size
+        const size_t CHUNK = 512;
+        const std::vector<size_t>& getters = m.toCPP;
+        std::vector<size_t> setters, stringSetters;
+        for (size_t i : m.fromCPP) {
+            (variables[i].type == "STRING" ? stringSetters : setters).push_back(i);
+        }
+
+        out << "// Auto-generated client benchmark for: " << memoryName << "\n";
+        out << "// Build: g++ -O2 -std=c++17 -I<include> -I<bench> " << lowerName << "_bench.cpp\n\n";
+        out << "#include \"" << lowerName << "_client.hpp\"\n";
+        out << "#include \"BenchHarness.hpp\"\n\n";
+        out << "namespace {\n\n";
+
+        size_t getterChunks = (getters.size() + CHUNK - 1) / CHUNK;
+        for (size_t c = 0; c < getterChunks; c++) {
+            out << "double getters" << c << "(const " << clientName << "& client) {\n";
+            out << "    double acc = 0;\n";
+            for (size_t i = c * CHUNK; i < std::min(getters.size(), (c + 1) * CHUNK); i++) {
+                const Variable& v = variables[getters[i]];
+                out << "    acc += client.Get" << m.capitalized[getters[i]] << "()" << (v.type == "STRING" ? "[0]" : "") << ";\n";
+            }
+            out << "    return acc;\n";
+            out << "}\n\n";
+        }
+
+        // setters<c>(client, i) / stringSetters<c>(client, text), returns the chunk count
+        auto emitSetters = [&](const std::string& function, const std::string& className, const std::vector<size_t>& list,
+                               bool strings) {
+            size_t chunks = (list.size() + CHUNK - 1) / CHUNK;
+            for (size_t c = 0; c < chunks; c++) {
+                out << "void " << function << c << "(" << className << "& client, " << (strings ? "const char* text" : "uint64_t i")
+                    << ") {\n";
+                for (size_t i = c * CHUNK; i < std::min(list.size(), (c + 1) * CHUNK); i++) {
+                    const Variable& v = variables[list[i]];
+                    if (strings) {
+                        out << "    client.Set" << m.capitalized[list[i]] << "(text);\n";
+                    } else {
+                        out << "    client.Set" << m.capitalized[list[i]] << "(static_cast<" << v.type << ">(i"
+                            << (v.type == "BOOL" ? " & 1" : "") << "));\n";
+                    }
+                }
+                out << "}\n\n";
+            }
+            return chunks;
+        };
+        size_t setterChunks = emitSetters("setters", clientName, setters, false);
+        size_t stringChunks = emitSetters("stringSetters", clientName, stringSetters, true);
+
+        // Writer partitions: the numeric fields of each writer
+        std::vector<std::vector<size_t>> writerSetters(m.writers.size());
+        std::vector<size_t> writerChunks(m.writers.size());
+        for (size_t w = 0; w < m.writers.size(); w++) {
+            for (size_t i : m.writers[w].fields) {
+                if (variables[i].type != "STRING") writerSetters[w].push_back(i);
+            }
+            writerChunks[w] = emitSetters("writer" + m.writers[w].name + "Setters",
+                                          memoryName + m.writers[w].name + "Writer", writerSetters[w], false);
+        }
+
+        out << "} // namespace\n\n";
+
+        out << "int main(int argc, char **argv) {\n";
+        out << "    BenchHarness bench(\"" << memoryName << "\", argc, argv);\n\n";
+        out << "    TypedSharedMemory<ST_" << memoryName << "> plc;\n";
+        out << "    if (!plc.Create(L\"" << memoryName << "_bench\")) {\n";
+        out << "        std::cerr << \"Cannot create benchmark segment\" << std::endl;\n";
+        out << "        return 1;\n";
+        out << "    }\n";
+        out << "    " << clientName << " client;\n";
+        out << "    client.SetTransport(\"shm\");\n";
+        out << "    if (!client.Connect(L\"" << memoryName << "_bench\")) {\n";
+        out << "        std::cerr << \"Cannot attach to benchmark segment\" << std::endl;\n";
+        out << "        return 1;\n";
+        out << "    }\n\n";
+
+        if (!getters.empty()) {
+            out << "    bench.Run(\"getter\", " << getters.size() << ", [&](uint64_t) {\n";
+            out << "        double acc = 0;\n";
+            for (size_t c = 0; c < getterChunks; c++) out << "        acc += getters" << c << "(client);\n";
+            out << "        BenchHarness::Consume(acc);\n";
+            out << "    });\n";
+        }
+        if (!setters.empty()) {
+            out << "    bench.Run(\"setter\", " << setters.size() << ", [&](uint64_t i) {\n";
+            for (size_t c = 0; c < setterChunks; c++) out << "        setters" << c << "(client, i);\n";
+            out << "    });\n";
+        }
+        if (!stringSetters.empty()) {
+            out << "    bench.Run(\"string_setter\", " << stringSetters.size() << ", [&](uint64_t i) {\n";
+            out << "        const char* text = (i & 1) ? \"benchmark value\" : \"short\";\n";
+            for (size_t c = 0; c < stringChunks; c++) out << "        stringSetters" << c << "(client, text);\n";
+            out << "    });\n";
+        }
+        for (size_t w = 0; w < m.writers.size(); w++) {
+            const std::string& name = m.writers[w].name;
+            out << "    " << memoryName << name << "Writer writer" << name << ";\n";
+            out << "    if (!writer" << name << ".Connect(L\"" << memoryName << "_bench\")) {\n";
+            out << "        std::cerr << \"Cannot attach writer " << name << " to benchmark segment\" << std::endl;\n";
+            out << "        return 1;\n";
+            out << "    }\n";
+            out << "    // One partition update: Seq handshake, setters, heartbeat\n";
+            out << "    bench.Run(\"writer_" << name << "\", " << std::max<size_t>(1, writerSetters[w].size()) << ", [&](uint64_t i) {\n";
+            out << "        writer" << name << ".BeginUpdate();\n";
+            for (size_t c = 0; c < writerChunks[w]; c++) out << "        writer" << name << "Setters" << c << "(writer" << name << ", i);\n";
+            if (writerChunks[w] == 0) out << "        (void)i;\n";
+            out << "        writer" << name << ".EndUpdate();\n";
+            out << "        writer" << name << ".Sync();\n";
+            out << "    });\n";
+        }
+
+        // Group accessors of a partition belong to its writer
+        auto owner = [&](const std::string& writer) { return writer.empty() ? std::string("client") : "writer" + writer; };
+        auto ownerClass = [&](const std::string& writer) { return writer.empty() ? clientName : memoryName + writer + "Writer"; };
+        for (const auto& g : m.groups) {
+            const Variable& first = variables[g.second[0]];
+            bool toCPP = (first.direction == "toCPP");
+            out << "    std::vector<LREAL> " << g.first << "Values(" << ownerClass(first.writer) << "::" << g.first << "Count, 0.5);\n";
+            out << "    bench.Run(\"" << (toCPP ? "group_get_" : "group_set_") << g.first << "\", " << g.second.size()
+                << ", [&](uint64_t) {\n";
+            out << "        " << owner(first.writer) << "." << (toCPP ? "Get" : "Set") << g.first << "(" << g.first << "Values.data());\n";
+            if (toCPP) out << "        BenchHarness::Consume(" << g.first << "Values[0]);\n";
+            out << "    });\n";
+        }
+
+        for (const auto& g : bitGroups) {
+            std::string words = ownerClass(g.writer) + "::" + g.name + "Words";
+            out << "    std::vector<" << g.wordType << "> " << g.name << "Words(" << words << ", 0);\n";
+            if (g.direction == "toCPP") {
+                out << "    bench.Run(\"bits_count_" << g.name << "\", " << g.bits.size() << ", [&](uint64_t) {\n";
+                out << "        BenchHarness::Consume(client.Count" << g.name << "());\n";
+                out << "    });\n";
+                out << "    bench.Run(\"bits_changed_" << g.name << "\", " << g.bits.size() << ", [&](uint64_t i) {\n";
+                out << "        plc->ToCPP." << bitWordName(g.name, 0) << " = static_cast<" << g.wordType << ">(i);\n";
+                out << "        size_t sum = 0;\n";
+                out << "        client.ForEachChanged" << g.name << "(" << g.name << "Words.data(), [&](size_t bit, bool value) { sum += bit + value; });\n";
+                out << "        BenchHarness::Consume(sum);\n";
+                out << "    });\n";
+            } else {
+                out << "    bench.Run(\"bits_set_" << g.name << "\", " << g.bits.size() << ", [&](uint64_t i) {\n";
+                out << "        " << g.name << "Words[0] = static_cast<" << g.wordType << ">(i);\n";
+                out << "        " << owner(g.writer) << ".Set" << g.name << "(" << g.name << "Words.data());\n";
+                out << "    });\n";
+            }
+        }
+
+        out << "    bench.Run(\"sync\", 1, [&](uint64_t i) {\n";
+        out << "        plc->LifePLC = static_cast<DINT>(i);\n";
+        out << "        client.Sync();\n";
+        out << "    });\n";
+        out << "    bench.Run(\"sync_plc_stalled\", 1, [&](uint64_t) { client.Sync(); });\n";
+        out << "    bench.Run(\"is_plc_active\", 1, [&](uint64_t i) {\n";
+        out << "        plc->LifePLC = static_cast<DINT>(i >> 1);\n";
+        out << "        BenchHarness::Consume(client.IsPLCActive());\n";
+        out << "    });\n\n";
+
+        out << "    ST_ToCPP toCPP;\n";
+        out << "    ST_FromCPP fromCPP;\n";
+        out << "    std::memset(&fromCPP, 0, sizeof(fromCPP));\n";
+        out << "    bench.Run(\"copy_tocpp_bytes\", sizeof(ST_ToCPP), [&](uint64_t) {\n";
+        out << "        std::memcpy(&toCPP, &client->ToCPP, sizeof(ST_ToCPP));\n";
+        out << "        BenchHarness::Consume(toCPP);\n";
+        out << "    });\n";
+        out << "    bench.Run(\"copy_fromcpp_bytes\", sizeof(ST_FromCPP), [&](uint64_t) {\n";
+        out << "        std::memcpy(&client->FromCPP, &fromCPP, sizeof(ST_FromCPP));\n";
+        out << "    });\n\n";
+
+        out << "    return bench.Finish();\n";
+        out << "}\n";
+    }
+
+    // 9. Generate Virtual PLC (drives the segment like CODESYS would, for soak tests)
+    void generateVirtualPLC(const std::string& outputPath) {
+        const Model& m = model();
+        const std::string& lowerName = m.lowerName;
+        OutputBuffer out(outputPath, 8192 + variables.size() * 120);
+
+        std::vector<const Variable*> inputs;
+        for (size_t i : m.toCPP) {
+            if (variables[i].type != "STRING" && !isBitWord(variables[i])) inputs.push_back(&variables[i]);
+        }
+        for (const auto& g : bitGroups) {
+            if (g.direction != "toCPP") continue;
+            for (const auto& bit : g.bits) inputs.push_back(&bit);
+        }
+
+        out << "// Auto-generated virtual PLC for: " << memoryName << "\n";
+        out << "// Creates the segment, drives ToCPP with waveforms, increments LifePLC\n";
+        out << "// and checks that the controller keeps FromCPP/LifeCPP alive.\n\n";
+        out << "#include \"GenericSharedMemory.hpp\"\n";
+        out << "#include \"BridgeEncoding.hpp\"\n";
+        out << "#include \"" << lowerName << "_types.hpp\"\n";
+        if (lockstep) out << "#include \"Lockstep.hpp\"\n";
+        out << "#include <chrono>\n";
+        out << "#include <cmath>\n";
+        out << "#include <cstring>\n";
+        out << "#include <iostream>\n";
+        out << "#include <random>\n";
+        out << "#include <string>\n";
+        out << "#include <thread>\n";
+        out << "#include <vector>\n\n";
+        out << "using namespace std;\n\n";
+
+        out << "namespace {\n\n";
+        out << "enum Shape { SINE, STEP, RAMP, RANDOM, DEFAULT };\n\n";
+        out << "struct Waveform {\n";
+        out << "    Shape shape;\n";
+        out << "    double amplitude, period, offset;\n";
+        out << "};\n\n";
+
+        auto shapeName = [](const std::string& w) {
+            if (w == "sine") return "SINE";
+            if (w == "step") return "STEP";
+            if (w == "ramp") return "RAMP";
+            if (w == "random") return "RANDOM";
+            return "DEFAULT";
+        };
+
+        out << "// Per-variable stimulus from the schema (DEFAULT follows --wave)\n";
+        out << "Waveform waves[] = {\n";
+        for (const Variable* v : inputs) {
+            out << "    {" << shapeName(v->waveform) << ", " << v->amplitude << ", " << v->period << ", " << v->offset
+                << "},  // " << v->name << "\n";
+        }
+        if (inputs.empty()) out << "    {DEFAULT, 0, 1, 0}\n";
+        out << "};\n\n";
+
+        out << "mt19937 rng(12345);\n\n";
+        out << "double evaluate(const Waveform& w, double t) {\n";
+        out << "    double phase = fmod(t, w.period) / w.period;\n";
+        out << "    switch (w.shape) {\n";
+        out << "    case STEP:   return w.offset + (phase < 0.5 ? 0.0 : w.amplitude);\n";
+        out << "    case RAMP:   return w.offset + w.amplitude * phase;\n";
+        out << "    case RANDOM: return w.offset + w.amplitude * uniform_real_distribution<double>(-1.0, 1.0)(rng);\n";
+        out << "    default:     return w.offset + w.amplitude * sin(2.0 * 3.14159265358979323846 * phase);\n";
+        out << "    }\n";
+        out << "}\n\n";
+
+        const size_t CHUNK = 512;
+        size_t chunks = (inputs.size() + CHUNK - 1) / CHUNK;
+        for (size_t c = 0; c < chunks; c++) {
+            out << "void drive" << c << "(ST_ToCPP& d, double t) {\n";
+            for (size_t i = c * CHUNK; i < std::min(inputs.size(), (c + 1) * CHUNK); i++) {
+                const Variable& v = *inputs[i];
+                if (!v.bitGroup.empty()) {
+                    std::string word = "d." + bitWord(v), mask = bitMask(v);
+                    out << "    " << word << " = evaluate(waves[" << i << "], t) > 0 ? (" << word << " | " << mask << ") : ("
+                        << word << " & ~" << mask << ");\n";
+                } else if (v.type == "BOOL") {
+                    out << "    d." << v.name << " = evaluate(waves[" << i << "], t) > 0;\n";
+                } else if (!v.encoding.empty()) {
+                    out << "    d." << v.name << " = BridgeEncoding::Quantize<" << v.encoding << ">(evaluate(waves[" << i
+                        << "], t), " << literal(v.encodingScale) << ", " << literal(v.encodingOffset) << ");\n";
+                } else {
+                    out << "    d." << v.name << " = static_cast<" << v.type << ">(evaluate(waves[" << i << "], t));\n";
+                }
+            }
+            out << "}\n\n";
+        }
+
+        out << "void drive(ST_ToCPP& d, double t) {\n";
+        for (size_t c = 0; c < chunks; c++) out << "    drive" << c << "(d, t);\n";
+        if (chunks == 0) out << "    (void)d;\n    (void)t;\n";
+        out << "}\n\n";
+        if (lockstep) {
+            out << "// FNV-1a, compares the final FromCPP of lockstep runs\n";
+            out << "uint32_t checksum(const void* data, size_t size) {\n";
+            out << "    const unsigned char* bytes = static_cast<const unsigned char*>(data);\n";
+            out << "    uint32_t hash = 2166136261u;\n";
+            out << "    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;\n";
+            out << "    return hash;\n";
+            out << "}\n\n";
+        }
+        out << "} // namespace\n\n";
+
+        out << "int main(int argc, char **argv) {\n";
+        out << "    double cycleUs = 1000, durationS = 10, timeoutMs = 100;\n";
+        out << "    Shape shape = SINE;\n";
+        out << "    for (int i = 1; i + 1 < argc; i += 2) {\n";
+        out << "        string arg = argv[i];\n";
+        out << "        if (arg == \"--cycle-us\") cycleUs = atof(argv[i + 1]);\n";
+        out << "        else if (arg == \"--duration-s\") durationS = atof(argv[i + 1]);\n";
+        out << "        else if (arg == \"--timeout-ms\") timeoutMs = atof(argv[i + 1]);\n";
+        out << "        else if (arg == \"--wave\") {\n";
+        out << "            string w = argv[i + 1];\n";
+        out << "            if (w == \"sine\") shape = SINE;\n";
+        out << "            else if (w == \"step\") shape = STEP;\n";
+        out << "            else if (w == \"ramp\") shape = RAMP;\n";
+        out << "            else if (w == \"random\") shape = RANDOM;\n";
+        out << "            else {\n";
+        out << "                cerr << \"Unknown --wave: \" << w << \" (sine|step|ramp|random)\" << endl;\n";
+        out << "                return 2;\n";
+        out << "            }\n";
+        out << "        } else {\n";
+        out << "            cerr << \"Usage: " << lowerName << "_virtual_plc [--cycle-us 1000] [--duration-s 10]\"\n";
+        out << "                 << \" [--timeout-ms 100] [--wave sine|step|ramp|random]\" << endl;\n";
+        out << "            return 2;\n";
+        out << "        }\n";
+        out << "    }\n";
+        out << "    for (auto& w : waves) {\n";
+        out << "        if (w.shape == DEFAULT) w.shape = shape;\n";
+        out << "    }\n\n";
+
+        out << "    TypedSharedMemory<ST_" << memoryName << "> plc;\n";
+        out << "    plc.SetTransport(\"shm\");\n";
+        out << "    if (!plc.Create(L\"OKZiJMksN52vWF53\")) {\n";
+        out << "        cerr << \"Cannot create shared memory segment\" << endl;\n";
+        out << "        return 2;\n";
+        out << "    }\n";
+        out << "    cout << \"=== " << memoryName << " Virtual PLC: \" << cycleUs << \" us cycle, generation \"\n";
+        out << "         << plc->Header.Generation << \" ===\" << endl;\n\n";
+
+        out << "    typedef chrono::steady_clock clock;\n";
+        out << "    const auto cycle = chrono::duration_cast<clock::duration>(chrono::duration<double, micro>(cycleUs));\n";
+        out << "    const auto start = clock::now();\n";
+        out << "    const auto end = start + chrono::duration_cast<clock::duration>(chrono::duration<double>(durationS));\n";
+        out << "    auto next = start;\n\n";
+
+        const bool partitioned = !m.writers.empty();
+        const std::string st = "ST_" + memoryName;
+        // With writer partitions everything between FromCPP and LifePLC is controller-owned
+        const std::string fromCPPBytes = partitioned ? "fromCPPBytes" : "sizeof(ST_FromCPP)";
+        if (partitioned) {
+            out << "    const size_t fromCPPBytes = offsetof(" << st << ", LifePLC) - offsetof(" << st << ", FromCPP);\n";
+        }
+        out << "    vector<char> lastFromCPP(" << fromCPPBytes << ", 0);\n";
+        out << "    DINT lastLifeCPP = plc->LifeCPP;\n";
+        out << "    auto lastLifeChange = start;\n";
+        out << "    bool seenController = false;\n";
+        out << "    uint64_t cycles = 0, overruns = 0, lifeUpdates = 0, fromCPPUpdates = 0, staleEvents = 0;\n";
+        out << "    double maxLateUs = 0, maxGapMs = 0;\n";
+        out << "    bool stale = false;\n\n";
+
+        if (lockstep) out << "    uint64_t lockstepCycles = 0;\n\n";
+        if (partitioned) {
+            out << "    // Each writer partition has its own heartbeat\n";
+            out << "    struct Writer {\n";
+            out << "        const char* name;\n";
+            out << "        const volatile DINT* life;\n";
+            out << "        DINT last;\n";
+            out << "        clock::time_point lastChange;\n";
+            out << "        bool seen, stale;\n";
+            out << "        uint64_t updates, staleEvents;\n";
+            out << "        double maxGapMs;\n";
+            out << "    };\n";
+            out << "    Writer writers[] = {\n";
+            for (const auto& w : m.writers) {
+                out << "        {\"" << w.name << "\", &plc->FromCPP_" << w.name << ".Life, plc->FromCPP_" << w.name
+                    << ".Life, start, false, false, 0, 0, 0},\n";
+            }
+            out << "    };\n\n";
+        }
+
+        std::string indent = lockstep ? "            " : "        ";
+        out << "    while (next < end) {\n";
+        if (lockstep) {
+            out << "        double t;\n";
+            out << "        clock::time_point now;\n";
+            out << "        if (Lockstep::Load(&plc->Lockstep.Enable)) {\n";
+            out << "            // Lockstep: one cycle per simulation step, on simulated time\n";
+            out << "            bool turn = Lockstep::WaitUntil(&plc->Lockstep.SimDone, plc->Lockstep.PlcDone, 100);\n";
+            out << "            now = clock::now();\n";
+            out << "            next = now;\n";
+            out << "            if (!turn) continue;\n";
+            out << "            t = plc->Lockstep.PlcDone * (plc->Lockstep.StepMs / 1000.0);\n";
+            out << "            lockstepCycles++;\n";
+            out << "        } else {\n";
+        }
+        out << indent << "// Wait for the cycle start: sleep coarse, spin the last 200 us\n";
+        out << indent << "next += cycle;\n";
+        out << indent << "this_thread::sleep_until(next - chrono::microseconds(200));\n";
+        out << indent << "while (clock::now() < next) {}\n";
+        out << indent << (lockstep ? "" : "auto ") << "now = clock::now();\n";
+        out << indent << "double lateUs = chrono::duration<double, micro>(now - next).count();\n";
+        out << indent << "if (lateUs > maxLateUs) maxLateUs = lateUs;\n";
+        out << indent << "if (now - next > cycle) {\n";
+        out << indent << "    overruns++;\n";
+        out << indent << "    next = now;\n";
+        out << indent << "}\n";
+        if (lockstep) {
+            out << "            t = chrono::duration<double>(now - start).count();\n";
+            out << "        }\n";
+        }
+        out << "\n";
+
+        out << "        // Outputs to the controller\n";
+        if (!lockstep) out << "        double t = chrono::duration<double>(now - start).count();\n";
+        out << "        drive(plc->ToCPP, t);\n";
+        out << "        plc->LifePLC++;\n";
+        out << "        cycles++;\n";
+        if (lockstep) {
+            out << "        if (plc->Lockstep.Enable) Lockstep::Publish(&plc->Lockstep.PlcDone, plc->Lockstep.PlcDone + 1);\n";
+        }
+        out << "\n";
+
+        out << "        // Controller responsiveness\n";
+        out << "        if (plc->LifeCPP != lastLifeCPP) {\n";
+        out << "            double gapMs = chrono::duration<double, milli>(now - lastLifeChange).count();\n";
+        out << "            if (seenController && gapMs > maxGapMs) maxGapMs = gapMs;\n";
+        out << "            lastLifeCPP = plc->LifeCPP;\n";
+        out << "            lastLifeChange = now;\n";
+        out << "            lifeUpdates++;\n";
+        out << "            seenController = true;\n";
+        out << "            stale = false;\n";
+        out << "        } else if (seenController && !stale &&\n";
+        out << "                   chrono::duration<double, milli>(now - lastLifeChange).count() > timeoutMs) {\n";
+        out << "            stale = true;\n";
+        out << "            staleEvents++;\n";
+        out << "            cerr << \"LifeCPP stale after cycle \" << cycles << endl;\n";
+        out << "        }\n";
+        if (partitioned) {
+            out << "        for (Writer& w : writers) {\n";
+            out << "            if (*w.life != w.last) {\n";
+            out << "                double gapMs = chrono::duration<double, milli>(now - w.lastChange).count();\n";
+            out << "                if (w.seen && gapMs > w.maxGapMs) w.maxGapMs = gapMs;\n";
+            out << "                w.last = *w.life;\n";
+            out << "                w.lastChange = now;\n";
+            out << "                w.updates++;\n";
+            out << "                w.seen = true;\n";
+            out << "                w.stale = false;\n";
+            out << "            } else if (w.seen && !w.stale && chrono::duration<double, milli>(now - w.lastChange).count() > timeoutMs) {\n";
+            out << "                w.stale = true;\n";
+            out << "                w.staleEvents++;\n";
+            out << "                cerr << w.name << \" stale after cycle \" << cycles << endl;\n";
+            out << "            }\n";
+            out << "        }\n";
+        }
+        out << "        if (memcmp(lastFromCPP.data(), &plc->FromCPP, " << fromCPPBytes << ") != 0) {\n";
+        out << "            memcpy(lastFromCPP.data(), &plc->FromCPP, " << fromCPPBytes << ");\n";
+        out << "            fromCPPUpdates++;\n";
+        out << "        }\n";
+        out << "    }\n\n";
+
+        out << "    double seconds = chrono::duration<double>(clock::now() - start).count();\n";
+        out << "    cout << \"cycles:            \" << cycles << \" (\" << cycles / seconds << \" Hz)\" << endl;\n";
+        out << "    cout << \"overruns:          \" << overruns << \", max late \" << maxLateUs << \" us\" << endl;\n";
+        out << "    cout << \"LifeCPP updates:   \" << lifeUpdates << \", max gap \" << maxGapMs << \" ms\" << endl;\n";
+        out << "    cout << \"FromCPP updates:   \" << fromCPPUpdates << endl;\n";
+        out << "    cout << \"stale events:      \" << staleEvents << endl;\n";
+        if (partitioned) {
+            out << "    bool seenWriter = false;\n";
+            out << "    for (const Writer& w : writers) {\n";
+            out << "        cout << \"Life \" << w.name << \": \" << w.updates << \" updates, max gap \" << w.maxGapMs << \" ms, \"\n";
+            out << "             << w.staleEvents << \" stale events\" << endl;\n";
+            out << "        seenWriter = seenWriter || w.seen;\n";
+            out << "        staleEvents += w.staleEvents;\n";
+            out << "    }\n";
+        }
+        if (lockstep) {
+            out << "    cout << \"lockstep cycles:   \" << lockstepCycles << \", FromCPP checksum \"\n";
+            out << "         << hex << checksum(&plc->FromCPP, " << fromCPPBytes << ") << dec << endl;\n";
+        }
+        out << "\n";
+        out << "    // Soak test verdict\n";
+        if (partitioned) {
+            out << "    // Partition controllers leave LifeCPP alone, any heartbeat counts as a live controller\n";
+            out << "    if (!seenController && !seenWriter) {\n";
+            out << "        cerr << \"FAIL: no controller updated LifeCPP or a partition Life\" << endl;\n";
+        } else {
+            out << "    if (!seenController) {\n";
+            out << "        cerr << \"FAIL: controller never updated LifeCPP\" << endl;\n";
+        }
+        out << "        return 1;\n";
+        out << "    }\n";
+        out << "    if (staleEvents > 0) {\n";
+        out << "        cerr << \"FAIL: controller went stale\" << endl;\n";
+        out << "        return 1;\n";
+        out << "    }\n";
+        out << "    cout << \"PASS\" << endl;\n";
+        out << "    return 0;\n";
+        out << "}\n";
+    }
+
+    // Buffer protocol (Python struct) format of one segment field
+    static std::string bufferFormat(const Variable& var) {
+        const std::string& t = storageType(var);
+        if (t == "STRING") return std::to_string(var.size + 1) + "s";
+        if (t == "BOOL") return "?";
+        if (t == "SINT") return "b";
+        if (t == "INT") return "h";
+        if (t == "DINT" || t == "TIME") return "i";
+        if (t == "LINT" || t == "LTIME") return "q";
+        if (t == "REAL") return "f";
+        if (t == "LREAL") return "d";
+        switch (typeSize(var)) {
+        case 1: return "B";
+        case 2: return "H";
+        case 4: return "I";
+        default: return "Q";
+        }
+    }
+
+    // 10. Generate C ABI Library (implements BridgeCApi.h for this schema)
+    void generateCApi(const std::string& outputPath) {
+        const Model& m = model();
+        const std::string& lowerName = m.lowerName;
+        const std::string st = "ST_" + memoryName;
+        OutputBuffer out(outputPath, 8192 + variables.size() * 120);
+
+        out << "// Auto-generated C ABI library for: " << memoryName << "\n";
+        out << "// Build: g++ -std=c++17 -O2 -shared -fPIC -fvisibility=hidden -DBRIDGE_CAPI_BUILD " << lowerName
+            << "_bridge_capi.cpp -o lib" << lowerName << "bridge.so\n\n";
+        out << "#include \"BridgeCApi.h\"\n";
+        out << "#include \"GenericSharedMemory.hpp\"\n";
+        out << "#include \"" << lowerName << "_types.hpp\"\n";
+        out << "#include <atomic>\n";
+        out << "#include <cstring>\n";
+        out << "#include <string>\n\n";
+
+        out << "struct bridge_client {\n";
+        out << "    TypedSharedMemory<" << st << "> shm;\n";
+        out << "};\n\n";
+
+        // Segment order: ToCPP fields, then FromCPP fields, then the writer partitions
+        out << "namespace {\n\n";
+        out << "const bridge_field fields[] = {\n";
+        std::vector<const std::vector<size_t>*> blocks = {&m.toCPP, &m.fromCPP};
+        for (const auto& w : m.writers) blocks.push_back(&w.fields);
+        for (const std::vector<size_t>* block : blocks) {
+            for (size_t i : *block) {
+                const Variable& v = variables[i];
+                out << "    {\"" << v.name << "\", \"" << storageType(v) << "\", \"" << bufferFormat(v) << "\", "
+                    << (v.direction == "toCPP" ? "BRIDGE_TO_CPP" : "BRIDGE_FROM_CPP") << ", static_cast<uint32_t>(offsetof(" << st << ", "
+                    << blockOf(v) << ") + offsetof(" << blockType(v) << ", " << v.name << ")), " << m.layout.fields[i].size
+                    << ", " << literal(v.encodingScale) << ", " << literal(v.encodingOffset) << "},\n";
+            }
+        }
+        if (variables.empty()) out << "    {\"\", \"\", \"\", 0, 0, 0, 1, 0}\n";
+        out << "};\n";
+        out << "const uint32_t fieldCount = " << variables.size() << ";\n\n";
+        out << "} // namespace\n\n";
+
+        out << "extern \"C\" {\n\n";
+        out << "uint32_t bridge_abi_version(void) { return BRIDGE_ABI_VERSION; }\n";
+        out << "const char* bridge_schema_name(void) { return \"" << memoryName << "\"; }\n";
+        out << "size_t bridge_segment_size(void) { return sizeof(" << st << "); }\n";
+        out << "uint32_t bridge_life_plc_offset(void) { return static_cast<uint32_t>(offsetof(" << st << ", LifePLC)); }\n";
+        out << "uint32_t bridge_layout_hash(void) { return " << st << "::LayoutHash; }\n\n";
+
+        out << "const bridge_field* bridge_fields(uint32_t* count) {\n";
+        out << "    if (count) *count = fieldCount;\n";
+        out << "    return fields;\n";
+        out << "}\n\n";
+
+        out << "int32_t bridge_field_index(const char* name) {\n";
+        out << "    if (!name) return -1;\n";
+        out << "    for (uint32_t i = 0; i < fieldCount; i++) {\n";
+        out << "        if (std::strcmp(fields[i].name, name) == 0) return static_cast<int32_t>(i);\n";
+        out << "    }\n";
+        out << "    return -1;\n";
+        out << "}\n\n";
+
+        out << "bridge_client* bridge_connect(const char* memory_name) {\n";
+        out << "    std::string narrow = memory_name ? memory_name : \"OKZiJMksN52vWF53\";\n";
+        out << "    std::wstring name(narrow.begin(), narrow.end());\n";
+        out << "    bridge_client* client = new bridge_client();\n";
+        out << "    if (!client->shm.Connect(name.c_str())) {\n";
+        out << "        delete client;\n";
+        out << "        return nullptr;\n";
+        out << "    }\n";
+        out << "    return client;\n";
+        out << "}\n\n";
+
+        out << "void bridge_disconnect(bridge_client* client) {\n";
+        out << "    if (!client) return;\n";
+        out << "    client->shm.Disconnect();\n";
+        out << "    delete client;\n";
+        out << "}\n\n";
+
+        out << "void* bridge_data(bridge_client* client) {\n";
+        out << "    return client ? client->shm.GetPointer() : nullptr;\n";
+        out << "}\n\n";
+
+        out << "void* bridge_view(bridge_client* client, uint32_t first, uint32_t count, uint32_t* stride) {\n";
+        out << "    if (!client || !client->shm.IsConnected() || count == 0 || first >= fieldCount || count > fieldCount - first) return nullptr;\n";
+        out << "    uint32_t step = count > 1 ? fields[first + 1].offset - fields[first].offset : fields[first].size;\n";
+        out << "    for (uint32_t i = first + 1; i < first + count; i++) {\n";
+        out << "        if (std::strcmp(fields[i].type, fields[first].type) != 0 || fields[i].size != fields[first].size ||\n";
+        out << "            fields[i].offset != fields[i - 1].offset + step) return nullptr;\n";
+        out << "    }\n";
+        out << "    if (stride) *stride = step;\n";
+        out << "    return static_cast<char*>(client->shm.GetPointer()) + fields[first].offset;\n";
+        out << "}\n\n";
+
+        out << "uint32_t bridge_generation(bridge_client* client) {\n";
+        out << "    return client && client->shm.IsConnected() ? client->shm.GetGeneration() : 0;\n";
+        out << "}\n\n";
+
+        out << "void bridge_heartbeat(bridge_client* client, int32_t* life_plc, int32_t* life_cpp) {\n";
+        out << "    if (!client || !client->shm.IsConnected()) return;\n";
+        out << "    if (life_plc) *life_plc = client->shm->LifePLC;\n";
+        out << "    if (life_cpp) *life_cpp = client->shm->LifeCPP;\n";
+        out << "}\n\n";
+
+        out << "int bridge_is_plc_active(bridge_client* client) {\n";
+        out << "    return client && client->shm.IsPLCActive() ? 1 : 0;\n";
+        out << "}\n\n";
+
+        out << "void bridge_sync(bridge_client* client) {\n";
+        out << "    if (client) client->shm.Sync();\n";
+        out << "}\n\n";
+
+        out << "int bridge_snapshot(bridge_client* client, void* buffer, size_t size) {\n";
+        out << "    if (!client || !client->shm.IsConnected() || !buffer || size < sizeof(" << st << ")) return -1;\n";
+        out << "    const volatile DINT* life = &client->shm->LifePLC;\n";
+        out << "    for (int attempt = 0; attempt < 8; attempt++) {\n";
+        out << "        DINT before = *life;\n";
+        out << "        std::atomic_thread_fence(std::memory_order_acquire);\n";
+        out << "        std::memcpy(buffer, client->shm.GetPointer(), sizeof(" << st << "));\n";
+        out << "        std::atomic_thread_fence(std::memory_order_acquire);\n";
+        out << "        if (*life == before) return 1;\n";
+        out << "    }\n";
+        out << "    return 0;\n";
+        out << "}\n\n";
+
+        out << "int bridge_restore(bridge_client* client, const void* buffer, size_t size) {\n";
+        out << "    if (!client || !client->shm.IsConnected() || !buffer || size < sizeof(" << st << ")) return -1;\n";
+        out << "    const " << st << "* image = static_cast<const " << st << "*>(buffer);\n";
+        out << "    if (image->Header.LayoutHash != " << st << "::LayoutHash) return -1;\n";
+        out << "    std::memcpy(static_cast<void*>(&client->shm->FromCPP), &image->FromCPP, sizeof(image->FromCPP));\n";
+        out << "    std::atomic_thread_fence(std::memory_order_release);\n";
+        out << "    client->shm.Sync();\n";
+        out << "    return 0;\n";
+        out << "}\n\n";
+        out << "} // extern \"C\"\n";
+    }
+
+    // 11. Generate Webots Physics Plugin (joints exchanged every physics step)
+    void generatePhysicsPlugin(const std::string& outputPath) {
+        const Model& m = model();
+        const std::string& lowerName = m.lowerName;
+        OutputBuffer out(outputPath, 4096 + m.physics.size() * 400);
+
+        // One joint lookup per body, in declaration order
+        std::vector<std::string> bodies;
+        std::map<std::string, size_t> jointOf;
+        for (size_t i : m.physics) {
+            const std::string& body = variables[i].physicsBody;
+            if (jointOf.insert(std::make_pair(body, bodies.size())).second) bodies.push_back(body);
+        }
+        auto joint = [&](const Variable& v) { return "joints[" + std::to_string(jointOf[v.physicsBody]) + "]"; };
+        auto measure = [](const Variable& v, const std::string& j) {
+            return (v.physicsValue == "velocity" ? "dJointGetHingeAngleRate(" : "dJointGetHingeAngle(") + j + ")";
+        };
+
+        out << "// Auto-generated Webots physics plugin for: " << memoryName << "\n";
+        out << "// Applies the setpoints of the joints declared with \"physics\" and writes\n";
+        out << "// their states back every physics step (WorldInfo.basicTimeStep) instead of\n";
+        out << "// every controller step. Build it as plugins/physics/" << lowerName << "_physics/\n";
+        out << "// of the Webots project and set WorldInfo.physics to \"" << lowerName << "_physics\".\n\n";
+        out << "#include <ode/ode.h>\n";
+        out << "#include <plugins/physics.h>\n";
+        out << "#include <algorithm>\n";
+        out << "#include \"" << lowerName << "_client.hpp\"\n\n";
+
+        out << "namespace {\n\n";
+        out << memoryName << "Client client;\n";
+        out << "dJointID joints[" << bodies.size() << "];     // ";
+        for (size_t b = 0; b < bodies.size(); b++) out << (b ? ", " : "") << bodies[b];
+        out << "\n";
+        out << "unsigned long long steps = 0;\n";
+        out << "bool mismatch = false;\n\n";
+
+        out << "// Hinge joint moving 'def': attached as (parent, body), else the body's only hinge\n";
+        out << "dJointID findJoint(const char* def) {\n";
+        out << "    dBodyID body = dWebotsGetBodyFromDEF(def);\n";
+        out << "    if (!body) {\n";
+        out << "        dWebotsConsolePrintf(\"" << lowerName << "_physics: no solid with DEF %s\\n\", def);\n";
+        out << "        return nullptr;\n";
+        out << "    }\n";
+        out << "    dJointID any = nullptr;\n";
+        out << "    for (int i = 0; i < dBodyGetNumJoints(body); i++) {\n";
+        out << "        dJointID j = dBodyGetJoint(body, i);\n";
+        out << "        if (dJointGetType(j) != dJointTypeHinge) continue;\n";
+        out << "        if (dJointGetBody(j, 1) == body) return j;\n";
+        out << "        if (!any) any = j;\n";
+        out << "    }\n";
+        out << "    if (!any) dWebotsConsolePrintf(\"" << lowerName << "_physics: %s is not moved by a hinge joint\\n\", def);\n";
+        out << "    return any;\n";
+        out << "}\n\n";
+
+        out << "// Segment attach, retried every 100 physics steps until the PLC created it\n";
+        out << "bool attach() {\n";
+        out << "    if (client.IsConnected()) return true;\n";
+        out << "    if (mismatch || steps % 100 != 0) return false;\n";
+        out << "    if (client.Connect(L\"OKZiJMksN52vWF53\")) {\n";
+        out << "        dWebotsConsolePrintf(\"" << lowerName << "_physics: connected\\n\");\n";
+        out << "        return true;\n";
+        out << "    }\n";
+        out << "    if (client.GetStatus() == GenericSharedMemory::LAYOUT_MISMATCH) {\n";
+        out << "        dWebotsConsolePrintf(\"" << lowerName << "_physics: segment layout does not match " << memoryName
+            << ", regenerate the plugin\\n\");\n";
+        out << "        mismatch = true;\n";
+        out << "    }\n";
+        out << "    return false;\n";
+        out << "}\n\n";
+        out << "} // namespace\n\n";
+
+        out << "extern \"C\" {\n\n";
+        out << "void webots_physics_init() {\n";
+        out << "    client.SetTransport(\"shm\");     // Split-host setups exchange through the controller\n";
+        out << "    client.SetHeartbeatEnabled(false);  // LifeCPP stays with the controller\n";
+        for (size_t b = 0; b < bodies.size(); b++) {
+            out << "    joints[" << b << "] = findJoint(\"" << bodies[b] << "\");\n";
+        }
+        out << "    attach();\n";
+        out << "}\n\n";
+
+        out << "// Before each physics step: setpoints (PLC -> joint motors)\n";
+        out << "void webots_physics_step() {\n";
+        out << "    bool attached = attach();\n";
+        out << "    steps++;\n";
+        out << "    if (!attached) return;\n";
+        for (size_t i : m.physics) {
+            const Variable& v = variables[i];
+            if (v.direction != "toCPP") continue;
+            std::string j = joint(v);
+            out << "    if (" << j << ") {\n";
+            if (v.physicsValue == "velocity") {
+                out << "        dReal velocity = client.Get" << m.capitalized[i] << "();\n";
+            } else {
+                out << "        dReal velocity = " << v.physicsGain << " * (client.Get" << m.capitalized[i] << "() - "
+                    << measure(v, j) << ");\n";
+            }
+            out << "        dJointSetHingeParam(" << j << ", dParamVel, std::max<dReal>(" << -v.physicsMaxVelocity
+                << ", std::min<dReal>(" << v.physicsMaxVelocity << ", velocity)));\n";
+            out << "        dJointSetHingeParam(" << j << ", dParamFMax, " << v.physicsMaxForce << ");\n";
+            out << "    }\n";
+        }
+        out << "}\n\n";
+
+        out << "int webots_physics_collide(dGeomID, dGeomID) {\n";
+        out << "    return 0;   // Default collision handling\n";
+        out << "}\n\n";
+
+        out << "// After each physics step: joint states (joints -> PLC)\n";
+        out << "void webots_physics_step_end() {\n";
+        out << "    if (!client.IsConnected()) return;\n";
+        for (size_t i : m.physics) {
+            const Variable& v = variables[i];
+            if (v.direction != "fromCPP") continue;
+            std::string j = joint(v);
+            std::string value = measure(v, j);
+            if (v.type != "LREAL") value = "static_cast<" + v.type + ">(" + value + ")";
+            out << "    if (" << j << ") client.Set" << m.capitalized[i] << "(" << value << ");\n";
+        }
+        out << "    client.Sync();      // Follows PLC restarts, no heartbeat of its own\n";
+        out << "}\n\n";
+
+        out << "void webots_physics_cleanup() {\n";
+        out << "    client.Disconnect();\n";
+        out << "}\n\n";
+        out << "} // extern \"C\"\n";
     }
 
     // Master generation method
@@ -496,21 +2962,64 @@ public:
         std::string lowerName = baseName;
         std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
 
+        auto start = std::chrono::steady_clock::now();
+
         // Create output directories
-        createDirectories("generated");
-        createDirectories("generated\\codesys");
-        createDirectories("generated\\webots");
+        createDirectories(outputDir);
+        createDirectories(outputDir + "/codesys");
+        createDirectories(outputDir + "/webots");
+
+        // Optional layout pass - must run before any emitter
+        if (layoutOptimization) {
+            SegmentLayout before = computeLayout();
+            optimizeLayout();
+            buildModel();
+            generateLayoutReport(outputDir + "/" + lowerName + "_layout.txt", before, model().layout);
+            start = recordStage("layout", start);
+        }
+
+        // Index once; options may have changed since loadSchema
+        buildModel();
+        start = recordStage("index", start);
 
         // Generate files - cpp and webots together since they're used together
-        generatePLCopenXML("generated/codesys/" + lowerName + "_Types.xml");
-        generateCppTypes("generated/webots/" + lowerName + "_types.hpp");
-        generateCppClient("generated/webots/" + lowerName + "_client.hpp");
-        generateWebotsController("generated/webots/" + lowerName + "_controller.cpp");
-        generateReadme("generated/README_" + lowerName + ".md");
+        generatePLCopenXML(outputDir + "/codesys/" + lowerName + "_Types.xml");
+        start = recordStage("plcopenxml", start);
+        generateCppTypes(outputDir + "/webots/" + lowerName + "_types.hpp");
+        start = recordStage("types", start);
+        generateCppClient(outputDir + "/webots/" + lowerName + "_client.hpp");
+        start = recordStage("client", start);
+        generateWebotsController(outputDir + "/webots/" + lowerName + "_controller.cpp");
+        start = recordStage("controller", start);
+        generateReadme(outputDir + "/README_" + lowerName + ".md");
+        start = recordStage("readme", start);
+        generateUdpRelay(outputDir + "/webots/" + lowerName + "_udp_relay.cpp");
+        start = recordStage("udp_relay", start);
+        if (emitBenchmark) {
+            generateBenchmark(outputDir + "/webots/" + lowerName + "_bench.cpp");
+            start = recordStage("bench", start);
+        }
+        if (emitVirtualPLC) {
+            generateVirtualPLC(outputDir + "/webots/" + lowerName + "_virtual_plc.cpp");
+            start = recordStage("virtual_plc", start);
+        }
+        generateCApi(outputDir + "/webots/" + lowerName + "_bridge_capi.cpp");
+        start = recordStage("capi", start);
+        if (!model().physics.empty()) {
+            generatePhysicsPlugin(outputDir + "/webots/" + lowerName + "_physics.cpp");
+            start = recordStage("physics", start);
+        }
 
         // Copy generic libraries to webots folder for completeness
-        copyFile("GenericSharedMemory.hpp", "generated/webots/GenericSharedMemory.hpp");
-        copyFile("CodesysTypes.hpp", "generated/webots/CodesysTypes.hpp");
+        copyFile("include/GenericSharedMemory.hpp", outputDir + "/webots/GenericSharedMemory.hpp");
+        copyFile("include/UdpTransport.hpp", outputDir + "/webots/UdpTransport.hpp");
+        copyFile("include/BridgeEncoding.hpp", outputDir + "/webots/BridgeEncoding.hpp");
+        copyFile("include/BridgeCApi.h", outputDir + "/webots/BridgeCApi.h");
+        if (lockstep) copyFile("include/Lockstep.hpp", outputDir + "/webots/Lockstep.hpp");
+        copyFile("include/BridgeAsync.hpp", outputDir + "/webots/BridgeAsync.hpp");
+        copyFile("include/BridgeStats.hpp", outputDir + "/webots/BridgeStats.hpp");
+        copyFile("include/CodesysTypes.hpp", outputDir + "/webots/CodesysTypes.hpp");
+        recordStage("copy", start);
     }
 
 };
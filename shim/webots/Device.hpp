@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+/**
+ * Headless Webots API Shim - Device base
+ *
+ * Lightweight stand-in for the Webots C++ API so generated controllers can be
+ * compiled and benchmarked without the simulator. Only the calls used by
+ * generated controllers are provided.
+ */
+
+namespace webots {
+
+// Call counters reported by Robot when the controller exits
+struct ShimCounters {
+    uint64_t commands = 0;      // Actuator calls (setPosition, setVelocity, ...)
+    uint64_t reads = 0;         // Sensor reads (getValue, getValues, ...)
+    uint64_t enables = 0;       // enable()/disable() calls
+    uint64_t samples = 0;       // Sensor updates computed by the simulated world
+};
+
+inline ShimCounters& shimCounters() {
+    static ShimCounters counters;
+    return counters;
+}
+
+class Device {
+public:
+    explicit Device(const std::string& name) : name(name) {}
+    virtual ~Device() {}
+
+    const std::string& getName() const { return name; }
+
+    // Sampling period the world computes this device at (0 = not computed)
+    virtual int activePeriod() const { return 0; }
+
+    // World reset (Supervisor::simulationReset), devices keep their enabled periods
+    virtual void reset() {}
+
+protected:
+    // Deterministic synthetic signal per device: phase from the name, driven by simulation time
+    double synthetic(double time) const {
+        uint32_t hash = 2166136261u;
+        for (char c : name) hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        double phase = (hash % 628) / 100.0;
+        return std::sin(time + phase);
+    }
+
+private:
+    std::string name;
+};
+
+// Sensor enabled with a sampling period, reads follow simulation time
+class Sensor : public Device {
+public:
+    Sensor(const std::string& name, const double* time) : Device(name), time(time), samplingPeriod(0) {}
+
+    void enable(int period) { shimCounters().enables++; samplingPeriod = period; }
+    void disable() { shimCounters().enables++; samplingPeriod = 0; }
+    int getSamplingPeriod() const { return samplingPeriod; }
+    int activePeriod() const override { return samplingPeriod; }
+
+protected:
+    // Reads count towards the report; disabled sensors return 0 (Webots: NaN + warning)
+    bool read() const {
+        shimCounters().reads++;
+        return samplingPeriod > 0;
+    }
+
+    const double* time;
+    int samplingPeriod;
+};
+
+} // namespace webots
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Device.hpp"
+
+namespace webots {
+
+class DistanceSensor : public Sensor {
+public:
+    DistanceSensor(const std::string& name, const double* time) : Sensor(name, time) {}
+
+    // Raw lookup-table value, 0...1000
+    double getValue() const {
+        if (!read()) return 0.0;
+        return 500.0 + 500.0 * synthetic(*time);
+    }
+};
+
+} // namespace webots
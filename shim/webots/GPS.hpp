@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Device.hpp"
+
+namespace webots {
+
+class GPS : public Sensor {
+public:
+    GPS(const std::string& name, const double* time) : Sensor(name, time), values() {}
+
+    const double* getValues() const {
+        bool enabled = read();
+        double s = enabled ? synthetic(*time) : 0.0;
+        values[0] = s;
+        values[1] = enabled ? 0.5 : 0.0;
+        values[2] = -s;
+        return values;
+    }
+
+private:
+    mutable double values[3];
+};
+
+} // namespace webots
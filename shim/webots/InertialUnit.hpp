@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Device.hpp"
+
+namespace webots {
+
+class InertialUnit : public Sensor {
+public:
+    InertialUnit(const std::string& name, const double* time) : Sensor(name, time), rollPitchYaw() {}
+
+    const double* getRollPitchYaw() const {
+        bool enabled = read();
+        double s = enabled ? synthetic(*time) : 0.0;
+        rollPitchYaw[0] = 0.1 * s;
+        rollPitchYaw[1] = -0.1 * s;
+        rollPitchYaw[2] = 3.0 * s;
+        return rollPitchYaw;
+    }
+
+private:
+    mutable double rollPitchYaw[3];
+};
+
+} // namespace webots
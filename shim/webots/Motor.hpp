@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Device.hpp"
+
+namespace webots {
+
+class Motor : public Device {
+public:
+    explicit Motor(const std::string& name)
+        : Device(name), targetPosition(0), velocity(10), torque(0), torqueSamplingPeriod(0) {}
+
+    void setPosition(double position) { shimCounters().commands++; targetPosition = position; }
+    void setVelocity(double vel) { shimCounters().commands++; velocity = vel; }
+    void setTorque(double t) { shimCounters().commands++; torque = t; }
+
+    double getTargetPosition() const { return targetPosition; }
+    double getVelocity() const { return velocity; }
+
+    void enableTorqueFeedback(int samplingPeriod) { shimCounters().enables++; torqueSamplingPeriod = samplingPeriod; }
+    void disableTorqueFeedback() { shimCounters().enables++; torqueSamplingPeriod = 0; }
+    int getTorqueFeedbackSamplingPeriod() const { return torqueSamplingPeriod; }
+    int activePeriod() const override { return torqueSamplingPeriod; }
+    void reset() override { targetPosition = 0; torque = 0; }
+    double getTorqueFeedback() const {
+        shimCounters().reads++;
+        return torqueSamplingPeriod > 0 ? 0.1 * targetPosition + torque : 0.0;
+    }
+
+private:
+    double targetPosition;
+    double velocity;
+    double torque;
+    int torqueSamplingPeriod;
+};
+
+} // namespace webots
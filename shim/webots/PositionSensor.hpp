@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Device.hpp"
+#include "Motor.hpp"
+
+namespace webots {
+
+class PositionSensor : public Sensor {
+public:
+    PositionSensor(const std::string& name, const Motor* motor, const double* time)
+        : Sensor(name, time), motor(motor) {}
+
+    // Follows the paired motor (ideal servo), otherwise a synthetic signal
+    double getValue() const {
+        if (!read()) return 0.0;
+        return motor ? motor->getTargetPosition() : synthetic(*time);
+    }
+
+private:
+    const Motor* motor;
+};
+
+} // namespace webots
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "Device.hpp"
+#include "Motor.hpp"
+#include "PositionSensor.hpp"
+#include "TouchSensor.hpp"
+#include "InertialUnit.hpp"
+#include "GPS.hpp"
+#include "DistanceSensor.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#endif
+
+/**
+ * Headless Webots API Shim - Robot
+ *
+ * step() returns immediately (maximum speed) and advances simulated time.
+ * The controller ends after WEBOTS_SHIM_STEPS steps (default 10000); on exit
+ * the Robot prints the controller cost per step (wall and CPU time, measured
+ * between step() calls), the device calls issued and the sensor updates the
+ * world computed (one per enabled device and elapsed sampling period). Set
+ * WEBOTS_SHIM_REPORT to a path to also write the report as JSON.
+ * WEBOTS_SHIM_EPISODE_STEPS resets the world every that many steps, like a
+ * supervisor calling simulationReset(): time restarts at 0, motors at 0.
+ *
+ * Build a generated controller against the shim:
+ *   g++ -O2 -std=c++17 -Ishim -Iinclude -Igenerated/webots generated/webots/<name>_controller.cpp
+ */
+
+namespace webots {
+
+class Robot {
+public:
+    Robot() : time(0), steps(0), maxSteps(10000), episodeSteps(0), episodes(1), basicTimeStep(8),
+              wallNs(0), cpuNs(0), measuring(false) {
+        const char* env = std::getenv("WEBOTS_SHIM_STEPS");
+        if (env) maxSteps = std::strtoull(env, nullptr, 10);
+        env = std::getenv("WEBOTS_SHIM_EPISODE_STEPS");
+        if (env) episodeSteps = std::strtoull(env, nullptr, 10);
+        env = std::getenv("WEBOTS_SHIM_BASIC_TIME_STEP");
+        if (env) basicTimeStep = std::atof(env);
+    }
+
+    virtual ~Robot() {
+        report();
+    }
+
+    Robot(const Robot&) = delete;
+    Robot& operator=(const Robot&) = delete;
+
+    int step(int duration) {
+        auto wall = std::chrono::steady_clock::now();
+        double cpu = cpuTimeNs();
+        if (measuring) {
+            wallNs += std::chrono::duration<double, std::nano>(wall - lastWall).count();
+            cpuNs += cpu - lastCpu;
+        }
+
+        if (episodeSteps > 0 && steps > 0 && steps < maxSteps && steps % episodeSteps == 0) {
+            time = 0;
+            for (Device* device : all) device->reset();
+            episodes++;
+        }
+        long long before = std::llround(time * 1000.0);
+        time += duration / 1000.0;
+        sample(before, std::llround(time * 1000.0));
+        if (++steps > maxSteps) {
+            measuring = false;
+            return -1;
+        }
+
+        measuring = true;
+        lastWall = std::chrono::steady_clock::now();
+        lastCpu = cpuTimeNs();
+        return 0;
+    }
+
+    double getTime() const { return time; }
+    double getBasicTimeStep() const { return basicTimeStep; }
+    std::string getName() const { return "shim"; }
+
+    Motor* getMotor(const std::string& name) {
+        return getDevice<Motor>(motors, name, [&]() { return new Motor(name); });
+    }
+
+    // A sensor named "<motor>_sensor" (or "<motor>sensor") follows that motor
+    PositionSensor* getPositionSensor(const std::string& name) {
+        return getDevice<PositionSensor>(positionSensors, name, [&]() {
+            const Motor* motor = nullptr;
+            size_t cut = name.rfind("sensor");
+            if (cut != std::string::npos && cut > 0) {
+                std::string base = name.substr(0, cut);
+                if (base.back() == '_') base.pop_back();
+                motor = getMotor(base);
+            }
+            return new PositionSensor(name, motor, &time);
+        });
+    }
+
+    TouchSensor* getTouchSensor(const std::string& name) {
+        return getDevice<TouchSensor>(touchSensors, name, [&]() { return new TouchSensor(name, &time); });
+    }
+
+    InertialUnit* getInertialUnit(const std::string& name) {
+        return getDevice<InertialUnit>(inertialUnits, name, [&]() { return new InertialUnit(name, &time); });
+    }
+
+    GPS* getGPS(const std::string& name) {
+        return getDevice<GPS>(gpses, name, [&]() { return new GPS(name, &time); });
+    }
+
+    DistanceSensor* getDistanceSensor(const std::string& name) {
+        return getDevice<DistanceSensor>(distanceSensors, name, [&]() { return new DistanceSensor(name, &time); });
+    }
+
+private:
+    template<typename T, typename Factory>
+    T* getDevice(std::map<std::string, std::unique_ptr<T>>& devices, const std::string& name, Factory create) {
+        auto it = devices.find(name);
+        if (it != devices.end()) return it->second.get();
+        T* device = create();
+        devices[name].reset(device);
+        all.push_back(device);
+        return device;
+    }
+
+    // World side of sampling: every enabled device is updated once per elapsed period
+    void sample(long long beforeMs, long long nowMs) const {
+        for (const Device* device : all) {
+            int period = device->activePeriod();
+            if (period > 0) {
+                shimCounters().samples += static_cast<uint64_t>(nowMs / period - beforeMs / period);
+            }
+        }
+    }
+
+    double time;
+    uint64_t steps, maxSteps;
+    uint64_t episodeSteps, episodes;
+    double basicTimeStep;
+    double wallNs, cpuNs;
+    bool measuring;
+    std::chrono::steady_clock::time_point lastWall;
+    double lastCpu;
+
+    std::map<std::string, std::unique_ptr<Motor>> motors;
+    std::map<std::string, std::unique_ptr<PositionSensor>> positionSensors;
+    std::map<std::string, std::unique_ptr<TouchSensor>> touchSensors;
+    std::map<std::string, std::unique_ptr<InertialUnit>> inertialUnits;
+    std::map<std::string, std::unique_ptr<GPS>> gpses;
+    std::map<std::string, std::unique_ptr<DistanceSensor>> distanceSensors;
+    std::vector<Device*> all;
+
+    static double cpuTimeNs() {
+#ifdef _WIN32
+        FILETIME create, exit, kernel, user;
+        GetProcessTimes(GetCurrentProcess(), &create, &exit, &kernel, &user);
+        ULARGE_INTEGER k, u;
+        k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+        u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+        return static_cast<double>(k.QuadPart + u.QuadPart) * 100.0;
+#else
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+#endif
+    }
+
+    void report() const {
+        uint64_t measured = steps > maxSteps ? maxSteps : steps;
+        if (measured == 0) return;
+        const ShimCounters& c = shimCounters();
+        double n = static_cast<double>(measured);
+
+        std::fprintf(stderr, "=== Webots shim report ===\n");
+        std::fprintf(stderr, "steps:            %llu (%.3f s simulated)\n", static_cast<unsigned long long>(measured), time);
+        if (episodeSteps > 0) std::fprintf(stderr, "episodes:         %llu\n", static_cast<unsigned long long>(episodes));
+        std::fprintf(stderr, "wall per step:    %.1f ns\n", wallNs / n);
+        std::fprintf(stderr, "cpu per step:     %.1f ns\n", cpuNs / n);
+        std::fprintf(stderr, "commands/step:    %.2f\n", c.commands / n);
+        std::fprintf(stderr, "reads/step:       %.2f\n", c.reads / n);
+        std::fprintf(stderr, "enable calls:     %llu\n", static_cast<unsigned long long>(c.enables));
+        std::fprintf(stderr, "samples/step:     %.2f\n", c.samples / n);
+
+        const char* path = std::getenv("WEBOTS_SHIM_REPORT");
+        if (!path) return;
+        FILE* f = std::fopen(path, "w");
+        if (!f) return;
+        std::fprintf(f, "{\"steps\": %llu, \"wall_ns_per_step\": %.3f, \"cpu_ns_per_step\": %.3f, "
+                        "\"commands\": %llu, \"reads\": %llu, \"enables\": %llu, \"samples\": %llu}\n",
+                     static_cast<unsigned long long>(measured), wallNs / n, cpuNs / n,
+                     static_cast<unsigned long long>(c.commands), static_cast<unsigned long long>(c.reads),
+                     static_cast<unsigned long long>(c.enables), static_cast<unsigned long long>(c.samples));
+        std::fclose(f);
+    }
+};
+
+} // namespace webots
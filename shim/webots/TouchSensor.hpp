@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Device.hpp"
+
+namespace webots {
+
+class TouchSensor : public Sensor {
+public:
+    TouchSensor(const std::string& name, const double* time) : Sensor(name, time) {}
+
+    // Bumper: in contact for a short part of every synthetic period
+    double getValue() const {
+        if (!read()) return 0.0;
+        return synthetic(*time) > 0.9 ? 1.0 : 0.0;
+    }
+};
+
+} // namespace webots
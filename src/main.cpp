@@ -3,13 +3,22 @@
 
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::cerr << "Usage: unified_codegen <schema.json>" << std::endl;
+        std::cerr << "Usage: unified_codegen <schema.json> [options]" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --optimize-layout        Reorder fields (hot first, by alignment)" << std::endl;
+        std::cerr << "  --layout packed|aligned  Struct packing (default: schema or packed)" << std::endl;
+        std::cerr << "  --out <dir>              Output directory (default: generated)" << std::endl;
+        std::cerr << "  --bench                  Also emit the client microbenchmark" << std::endl;
+        std::cerr << "  --virtual-plc            Also emit a virtual PLC for load tests" << std::endl;
+        std::cerr << "  --lockstep               Step Webots and the PLC in lockstep" << std::endl;
+        std::cerr << "  --timings                Print the time spent per generation stage" << std::endl;
         std::cerr << "Example: unified_codegen schemas/puma560.json" << std::endl;
         return 1;
     }
 
     try {
         UnifiedCodeGenerator gen;
+        bool timings = false;
         
         std::cout << "============================================\n";
         std::cout << " Unified Robot Code Generator\n";
@@ -18,9 +27,39 @@ int main(int argc, char** argv) {
         
         std::cout << "Loading schema: " << argv[1] << std::endl;
         gen.loadSchema(argv[1]);
+
+        // Command line options override the schema
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--optimize-layout") {
+                gen.layoutOptimization = true;
+            } else if (arg == "--layout" && i + 1 < argc) {
+                gen.layoutMode = argv[++i];
+                if (gen.layoutMode != "packed" && gen.layoutMode != "aligned") {
+                    throw std::runtime_error("Invalid layout: " + gen.layoutMode);
+                }
+            } else if (arg == "--out" && i + 1 < argc) {
+                gen.outputDir = argv[++i];
+            } else if (arg == "--bench") {
+                gen.emitBenchmark = true;
+            } else if (arg == "--virtual-plc") {
+                gen.emitVirtualPLC = true;
+            } else if (arg == "--lockstep") {
+                gen.lockstep = true;
+            } else if (arg == "--timings") {
+                timings = true;
+            } else {
+                throw std::runtime_error("Unknown option: " + arg);
+            }
+        }
         
         std::cout << "Schema: " << gen.memoryName << std::endl;
         std::cout << "Variables: " << gen.variables.size() << std::endl;
+        if (!gen.writerNames.empty()) {
+            std::cout << "Writer partitions:";
+            for (const auto& writer : gen.writerNames) std::cout << " " << writer;
+            std::cout << std::endl;
+        }
         std::cout << "UUIDs generated: " << gen.uuidMain.substr(0, 8) << "...\n\n";
 
         std::string lowerName = gen.memoryName;
@@ -36,16 +75,40 @@ int main(int argc, char** argv) {
         std::cout << "✓ C++ Client:        webots/" << lowerName << "_client.hpp\n";
         std::cout << "✓ Webots Controller: webots/" << lowerName << "_controller.cpp\n";
         std::cout << "✓ Usage README:      README_" << lowerName << ".md\n";
+        std::cout << "✓ UDP Relay:         webots/" << lowerName << "_udp_relay.cpp\n";
+        std::cout << "✓ C ABI Library:     webots/" << lowerName << "_bridge_capi.cpp\n";
+        if (gen.emitBenchmark) {
+            std::cout << "✓ Benchmark:         webots/" << lowerName << "_bench.cpp\n";
+        }
+        if (gen.emitVirtualPLC) {
+            std::cout << "✓ Virtual PLC:       webots/" << lowerName << "_virtual_plc.cpp\n";
+        }
+        if (!gen.model().physics.empty()) {
+            std::cout << "✓ Physics Plugin:    webots/" << lowerName << "_physics.cpp\n";
+        }
+        if (gen.layoutOptimization) {
+            std::cout << "✓ Layout Report:     " << lowerName << "_layout.txt\n";
+        }
         std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n";
+
+        if (timings) {
+            double total = 0;
+            std::cout << "Stage timings:\n";
+            for (const auto& stage : gen.stageTimes) {
+                std::printf("  %-12s %9.2f ms\n", stage.first.c_str(), stage.second);
+                total += stage.second;
+            }
+            std::printf("  %-12s %9.2f ms\n\n", "total", total);
+        }
         
         std::cout << "✨ Generation complete!\n\n";
         
         std::cout << "Next steps:\n";
-        std::cout << "  1. CODESYS: Import PLCopenXML from generated/codesys/\n";
-        std::cout << "  2. Webots:  Copy all files from generated/webots/ to controller\n";
-        std::cout << "  3. C++:     Use client from generated/webots/ (standalone)\n\n";
+        std::cout << "  1. CODESYS: Import PLCopenXML from " << gen.outputDir << "/codesys/\n";
+        std::cout << "  2. Webots:  Copy all files from " << gen.outputDir << "/webots/ to controller\n";
+        std::cout << "  3. C++:     Use client from " << gen.outputDir << "/webots/ (standalone)\n\n";
         
-        std::cout << "See generated/README_" << lowerName << ".md for detailed instructions.\n";
+        std::cout << "See " << gen.outputDir << "/README_" << lowerName << ".md for detailed instructions.\n";
 
     } catch (const std::exception& e) {
         std::cerr << "ERROR: " << e.what() << std::endl;
@@ -0,0 +1,92 @@
+// DynamicBridgeClient against a segment created by the generated client of
+// the same schema: it must attach (same size and layout hash), every handle
+// must sit at the offsetof of the generated types (from the schema's C ABI
+// field table) and a write through a handle must land inside that field.
+//
+//   dynamic_client <schema.json>
+//
+// Built per schema with -DCLIENT_HEADER="<name>_client.hpp" -DCLIENT=<Name>Client.
+#include CLIENT_HEADER
+#include "BridgeCApi.h"
+#include "DynamicBridgeClient.hpp"
+
+#include <cstdio>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Usage: dynamic_client <schema.json>\n");
+        return 2;
+    }
+
+    const std::wstring name = L"dynamic_client_test_" + std::wstring(bridge_schema_name(), bridge_schema_name() + std::strlen(bridge_schema_name()));
+    CLIENT owner;
+    if (!owner.Create(name.c_str())) {
+        std::printf("FAIL: generated client cannot create the segment\n");
+        return 1;
+    }
+
+    DynamicBridgeClient dyn(argv[1]);
+    check(dyn.SegmentSize() == bridge_segment_size(), "segment size " + std::to_string(dyn.SegmentSize()) +
+                                                      ", sizeof " + std::to_string(bridge_segment_size()));
+    if (!dyn.Connect(name.c_str())) {
+        std::printf("FAIL: DynamicBridgeClient cannot attach (status %d)\n", static_cast<int>(dyn.GetStatus()));
+        return 1;
+    }
+
+    uint32_t count = 0;
+    const bridge_field* fields = bridge_fields(&count);
+    unsigned char* segment = static_cast<unsigned char*>(owner.GetPointer());
+    std::vector<unsigned char> before(bridge_segment_size());
+    for (const std::string& field : dyn.Names()) {
+        const DynamicBridgeClient::Handle h = dyn.Find(field);
+        int32_t index = bridge_field_index(field.c_str());
+        if (h.kind == DynamicBridgeClient::KIND_BIT) {
+            check(index < 0 && h.mask != 0, field + ": packed bit");
+        } else if (index < 0) {
+            check(false, field + " missing from the generated types");
+            continue;
+        } else {
+            check(h.offset == fields[index].offset, field + ": handle offset " + std::to_string(h.offset) +
+                                                    ", offsetof " + std::to_string(fields[index].offset));
+            check(h.size == fields[index].size, field + ": handle size");
+        }
+
+        // A write through the handle changes bytes of this field only
+        std::memcpy(before.data(), segment, before.size());
+        if (h.kind == DynamicBridgeClient::KIND_STRING) dyn.SetString(h, "x");
+        else dyn.Set(h, 1.0);
+        size_t changed = 0, outside = 0;
+        for (size_t i = 0; i < before.size(); i++) {
+            if (segment[i] == before[i]) continue;
+            changed++;
+            if (i < h.offset || i >= h.offset + h.size) outside++;
+        }
+        check(changed > 0 && outside == 0, field + ": write lands in the field");
+        if (h.kind != DynamicBridgeClient::KIND_STRING) {
+            check(std::abs(dyn.Get(h) - 1.0) < 1e-6, field + ": read back");
+            dyn.Set(h, 0.0);
+        }
+    }
+
+    owner->LifePLC = 1234;
+    check(dyn.LifePLC() == 1234, "LifePLC through the dynamic client");
+
+    dyn.Disconnect();
+    owner.Disconnect();
+    if (failures) return 1;
+    std::printf("dynamic_client: %s OK (%zu handles)\n", bridge_schema_name(), dyn.Names().size());
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Layout model against the compiler: every FieldSlot the generator computes
+// must match offsetof in the generated types, and totalSize must match
+// sizeof(ST_<Name>). The compiler's values come from the field table of the
+// schema's C ABI library, which is linked in.
+//
+//   layout_check <schema.json>
+#include "UnifiedCodeGenerator.hpp"
+#include "BridgeCApi.h"
+
+#include <cstdio>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Usage: layout_check <schema.json>\n");
+        return 2;
+    }
+
+    UnifiedCodeGenerator gen;
+    gen.loadSchema(argv[1]);
+    if (gen.layoutOptimization) gen.optimizeLayout();
+    gen.buildModel();
+    const UnifiedCodeGenerator::Model& m = gen.model();
+    const UnifiedCodeGenerator::SegmentLayout& layout = m.layout;
+
+    if (gen.memoryName != bridge_schema_name()) {
+        std::printf("FAIL: %s linked against the C ABI of %s\n", gen.memoryName.c_str(), bridge_schema_name());
+        return 1;
+    }
+
+    uint32_t count = 0;
+    const bridge_field* fields = bridge_fields(&count);
+    check(count == layout.fields.size(), "field count");
+    for (const UnifiedCodeGenerator::FieldSlot& slot : layout.fields) {
+        int32_t index = bridge_field_index(slot.name.c_str());
+        if (index < 0) {
+            check(false, slot.name + " missing from the generated types");
+            continue;
+        }
+        const bridge_field& f = fields[index];
+        check(f.offset == slot.offset, slot.name + ": model offset " + std::to_string(slot.offset) +
+                                       ", offsetof " + std::to_string(f.offset));
+        check(f.size == slot.size, slot.name + ": model size " + std::to_string(slot.size) +
+                                   ", sizeof " + std::to_string(f.size));
+        check((f.direction == BRIDGE_TO_CPP) == (slot.direction == "toCPP"), slot.name + ": direction");
+    }
+    check(layout.totalSize == bridge_segment_size(), "totalSize " + std::to_string(layout.totalSize) +
+                                                     ", sizeof " + std::to_string(bridge_segment_size()));
+    check(layout.lifePLCOffset == bridge_life_plc_offset(), "LifePLC offset " + std::to_string(layout.lifePLCOffset) +
+                                                            ", offsetof " + std::to_string(bridge_life_plc_offset()));
+    check(m.layoutHash == bridge_layout_hash(), "layout hash");
+
+    if (failures) return 1;
+    std::printf("layout_check: %s OK (%zu fields, %zu bytes)\n", gen.memoryName.c_str(),
+                layout.fields.size(), layout.totalSize);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Loopback test of the UDP transport: full frames, deltas against the
+// acknowledged frame, fragmentation, the ack round trip between two peers
+// and a peer that restarts.
+#include "UdpTransport.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Layout stand-in: [ToCPP 0..split) [FromCPP split..life) [LifePLC] [LifeCPP]
+const size_t IMAGE = 8192;
+const size_t SPLIT = 6000;
+const size_t LIFE = IMAGE - 8;
+
+/** Receive until a frame arrives or the timeout expires */
+int receiveFrame(UdpTransport& t, void* image) {
+    for (int i = 0; i < 200; i++) {
+        int applied = t.Receive(image);
+        if (applied > 0) return applied;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+}
+
+bool sameRange(const uint8_t* a, const uint8_t* b, size_t from, size_t to) {
+    return std::memcmp(a + from, b + from, to - from) == 0;
+}
+
+} // namespace
+
+int main() {
+    UdpTransport::Config plcCfg, cppCfg;
+    if (!UdpTransport::ParseUri("udp://127.0.0.1:47811?bind=47810&mtu=1024", plcCfg) ||
+        !UdpTransport::ParseUri("udp://127.0.0.1:47810?bind=47811&mtu=1024", cppCfg)) {
+        std::printf("FAIL: ParseUri\n");
+        return 1;
+    }
+
+    UdpTransport plc, cpp;
+    auto plcTx = UdpTransport::RangesFor(UdpTransport::ROLE_PLC, SPLIT, LIFE);
+    auto cppTx = UdpTransport::RangesFor(UdpTransport::ROLE_CPP, SPLIT, LIFE);
+    if (!plc.Open(plcCfg, plcTx, cppTx) || !cpp.Open(cppCfg, cppTx, plcTx)) {
+        std::printf("FAIL: Open (ports 47810/47811 in use?)\n");
+        return 1;
+    }
+
+    static uint8_t plcImage[IMAGE], cppImage[IMAGE];
+    for (size_t i = 0; i < IMAGE; i++) plcImage[i] = static_cast<uint8_t>(i * 7);
+
+    // First frame has no acknowledged base: full, fragmented (SPLIT > mtu)
+    check(plc.Send(plcImage), "first Send");
+    check(receiveFrame(cpp, cppImage) == 1, "first frame received");
+    check(sameRange(plcImage, cppImage, 0, SPLIT), "ToCPP after full frame");
+    check(plc.GetStats().fullFrames == 1 && plc.GetStats().deltaFrames == 0, "first frame is full");
+
+    // Acknowledge, then small changes travel as deltas
+    for (int cycle = 1; cycle <= 20; cycle++) {
+        for (size_t k = 0; k < 4; k++) cppImage[SPLIT + k] = static_cast<uint8_t>(cycle + k);
+        check(cpp.Send(cppImage), "cpp Send");
+        check(receiveFrame(plc, plcImage) == 1, "ack frame received");
+        check(sameRange(plcImage, cppImage, SPLIT, LIFE), "FromCPP after cpp frame");
+
+        plcImage[cycle * 97 % SPLIT] ^= 0x5A;
+        plcImage[LIFE] = static_cast<uint8_t>(cycle);
+        check(plc.Send(plcImage), "plc Send");
+        check(receiveFrame(cpp, cppImage) == 1, "delta frame received");
+        check(sameRange(plcImage, cppImage, 0, SPLIT), "ToCPP after delta frame");
+        check(cppImage[LIFE] == plcImage[LIFE], "LifePLC after delta frame");
+    }
+    check(plc.GetStats().deltaFrames >= 19, "plc frames sent as deltas once acknowledged");
+    check(cpp.GetStats().framesLost == 0 && cpp.GetStats().framesDropped == 0, "no loss on loopback");
+
+    // Unacknowledged frames all delta against the last ack and decode in order
+    for (int k = 0; k < 5; k++) {
+        plcImage[100 + k] ^= 0xFF;
+        check(plc.Send(plcImage), "burst Send");
+    }
+    for (int i = 0; i < 200 && cpp.GetStats().framesReceived < 26; i++) {
+        cpp.Receive(cppImage);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    check(cpp.GetStats().framesReceived == 26, "burst frames received");
+    check(sameRange(plcImage, cppImage, 0, SPLIT), "ToCPP after burst");
+
+    // A large change falls back to a full frame
+    uint64_t fullBefore = plc.GetStats().fullFrames;
+    for (size_t i = 0; i < SPLIT; i++) plcImage[i] = static_cast<uint8_t>(~plcImage[i]);
+    check(plc.Send(plcImage), "full Send");
+    check(receiveFrame(cpp, cppImage) == 1, "full frame received");
+    check(plc.GetStats().fullFrames == fullBefore + 1, "large change sent as full frame");
+    check(sameRange(plcImage, cppImage, 0, SPLIT), "ToCPP after full fallback");
+
+    // A restarted peer counts from seq 1 again under a new session
+    check(cpp.Open(cppCfg, cppTx, plcTx), "reopen cpp");
+    static uint8_t restartImage[IMAGE];
+    for (int cycle = 1; cycle <= 3; cycle++) {
+        for (size_t k = 0; k < 4; k++) cppImage[SPLIT + k] = static_cast<uint8_t>(0xA0 + cycle + k);
+        check(cpp.Send(cppImage), "restarted cpp Send");
+        check(receiveFrame(plc, plcImage) == 1, "frame of restarted peer applied");
+        check(sameRange(plcImage, cppImage, SPLIT, LIFE), "FromCPP after peer restart");
+
+        plcImage[cycle] ^= 0x3C;
+        check(plc.Send(plcImage), "plc Send after peer restart");
+        check(receiveFrame(cpp, restartImage) == 1, "restarted peer receives");
+    }
+    check(plc.GetStats().peerRestarts == 1, "peer restart counted");
+    check(sameRange(plcImage, restartImage, 0, SPLIT), "ToCPP rebuilt on the restarted peer");
+
+    if (failures) return 1;
+    std::printf("udp_loopback: OK (%llu delta, %llu full frames)\n",
+                static_cast<unsigned long long>(plc.GetStats().deltaFrames),
+                static_cast<unsigned long long>(plc.GetStats().fullFrames));
+    return 0;
+}
@@ -0,0 +1,625 @@
+// shmtop - live, read-only view of a bridge segment, laid out from its schema
+//
+//   shmtop <schema.json> [--name <memory name>] [--filter <text>] [--hz <rate>]
+//          [--rows <n>] [--once] [--layout packed|aligned] [--optimize-layout] [--lockstep]
+//
+// The segment is mapped without write access and copied once per refresh, so
+// the PLC and the controller keep exclusive ownership of their cache lines
+// between refreshes. Values, sampled changes per second (refreshes in which
+// the field differed, so at most --hz) and the age of the last change are
+// shown per field, LifePLC/LifeCPP rates and staleness on top.
+// Keys: n/space next page, p/b previous page, / filter, c changing fields only, q quit.
+
+#ifdef _WIN32
+  #define NOMINMAX
+#endif
+
+#include "UnifiedCodeGenerator.hpp"
+#include "GenericSharedMemory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+  #include <conio.h>
+#else
+  #include <poll.h>
+  #include <sys/ioctl.h>
+  #include <termios.h>
+  #include <unistd.h>
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::string schema;
+    std::wstring name = L"OKZiJMksN52vWF53";
+    std::string filter;
+    double hz = 10.0;
+    int rows = 0;               // 0 = terminal height
+    bool once = false;
+    std::string layout;
+    bool optimize = false;
+    bool lockstep = false;
+};
+
+// Static description of one field, from the generator's layout
+struct Field {
+    std::string name;
+    std::string type;           // Storage type in the segment
+    std::string label;          // Type column, "INT:LREAL" for encoded fields
+    bool toCPP;
+    size_t offset, size;
+    bool encoded;
+    double scale, bias;
+};
+
+// Heartbeat counter with its rate over the last window and its staleness
+struct Heartbeat {
+    int32_t value = 0;
+    int32_t windowStart = 0;
+    double rate = 0.0;
+    Clock::time_point changed = Clock::now();
+};
+
+/**
+ * Samples the segment into a private image and tracks changes per field
+ * One sequential copy per refresh; comparisons and formatting run on the
+ * copy. Only fields in cache lines that differ from the last sample are
+ * compared, so mostly static 100k-field segments cost one memcmp per line.
+ * Multi-byte values may be torn while a writer is mid-update, which only
+ * affects the displayed sample.
+ */
+class Sampler {
+public:
+    Sampler(const std::vector<Field>& fields, size_t size, size_t lifePLC)
+        : fields(fields), lifePLC(lifePLC), current(size), previous(size),
+          changes(fields.size()), rates(fields.size()), lastChange(fields.size()),
+          changed(fields.size()), stamp(fields.size()), tick(0), windowStart(Clock::now()), primed(false) {
+        // Fields per cache line (CSR), a field spanning lines is listed in each
+        const size_t lines = (size + LINE - 1) / LINE;
+        lineStart.assign(lines + 1, 0);
+        for (const Field& f : fields) {
+            for (size_t l = f.offset / LINE; l <= (f.offset + f.size - 1) / LINE; l++) lineStart[l + 1]++;
+        }
+        for (size_t l = 0; l < lines; l++) lineStart[l + 1] += lineStart[l];
+        lineFields.resize(lineStart[lines]);
+        std::vector<size_t> fill(lineStart.begin(), lineStart.end() - 1);
+        for (size_t i = 0; i < fields.size(); i++) {
+            const Field& f = fields[i];
+            for (size_t l = f.offset / LINE; l <= (f.offset + f.size - 1) / LINE; l++) lineFields[fill[l]++] = i;
+        }
+    }
+
+    void Sample(const void* segment, Clock::time_point now) {
+        std::memcpy(current.data(), segment, current.size());
+        if (primed) {
+            const unsigned char* cur = current.data();
+            const unsigned char* prev = previous.data();
+            const size_t size = current.size();
+            tick++;
+            for (size_t l = 0; l + 1 < lineStart.size(); l++) {
+                size_t begin = l * LINE;
+                if (std::memcmp(cur + begin, prev + begin, std::min(LINE, size - begin)) == 0) continue;
+                for (size_t k = lineStart[l]; k < lineStart[l + 1]; k++) {
+                    size_t i = lineFields[k];
+                    const Field& f = fields[i];
+                    if (stamp[i] == tick || std::memcmp(cur + f.offset, prev + f.offset, f.size) == 0) continue;
+                    stamp[i] = tick;
+                    changes[i]++;
+                    lastChange[i] = now;
+                    changed[i] = 1;
+                }
+            }
+        }
+        beat(plc, lifePLC, now);
+        beat(cpp, lifePLC + 4, now);
+        primed = true;
+
+        // Rates over windows of about one second
+        double elapsed = std::chrono::duration<double>(now - windowStart).count();
+        if (elapsed >= 1.0) {
+            for (size_t i = 0; i < fields.size(); i++) {
+                rates[i] = changes[i] / elapsed;
+                changes[i] = 0;
+            }
+            plc.rate = static_cast<uint32_t>(plc.value - plc.windowStart) / elapsed;
+            cpp.rate = static_cast<uint32_t>(cpp.value - cpp.windowStart) / elapsed;
+            plc.windowStart = plc.value;
+            cpp.windowStart = cpp.value;
+            windowStart = now;
+        }
+        current.swap(previous);
+    }
+
+    // Latest sample (after Sample, the swap leaves it in 'previous')
+    const unsigned char* Image() const { return previous.data(); }
+    double Rate(size_t i) const { return rates[i]; }
+    bool Changed(size_t i) const { return changed[i] != 0; }
+    Clock::time_point LastChange(size_t i) const { return lastChange[i]; }
+    bool Recent(size_t i, Clock::time_point now) const {
+        return changed[i] && now - lastChange[i] < std::chrono::seconds(2);
+    }
+    const Heartbeat& PLC() const { return plc; }
+    const Heartbeat& CPP() const { return cpp; }
+
+    void Reset() {
+        primed = false;
+        std::fill(changes.begin(), changes.end(), 0u);
+        std::fill(rates.begin(), rates.end(), 0.0);
+        std::fill(changed.begin(), changed.end(), 0);
+        plc = Heartbeat();
+        cpp = Heartbeat();
+        windowStart = Clock::now();
+    }
+
+private:
+    void beat(Heartbeat& hb, size_t offset, Clock::time_point now) {
+        int32_t value;
+        std::memcpy(&value, current.data() + offset, sizeof(value));
+        if (!primed) hb.windowStart = value;
+        if (value != hb.value) hb.changed = now;
+        hb.value = value;
+    }
+
+    static constexpr size_t LINE = 64;
+
+    const std::vector<Field>& fields;
+    size_t lifePLC;
+    std::vector<unsigned char> current, previous;
+    std::vector<uint32_t> changes;      // Refreshes with a change, this window
+    std::vector<double> rates;
+    std::vector<Clock::time_point> lastChange;
+    std::vector<unsigned char> changed;
+    std::vector<size_t> lineStart, lineFields;
+    std::vector<uint32_t> stamp;        // Tick a field was last counted in
+    uint32_t tick;
+    Heartbeat plc, cpp;
+    Clock::time_point windowStart;
+    bool primed;
+};
+
+template<typename T>
+T load(const unsigned char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+// Raw value of a numeric storage type as double (encoded fields)
+double numeric(const unsigned char* p, const std::string& t) {
+    if (t == "SINT") return load<int8_t>(p);
+    if (t == "USINT") return load<uint8_t>(p);
+    if (t == "INT") return load<int16_t>(p);
+    if (t == "UINT") return load<uint16_t>(p);
+    if (t == "DINT") return load<int32_t>(p);
+    if (t == "UDINT") return load<uint32_t>(p);
+    if (t == "REAL") return load<float>(p);
+    return load<double>(p);
+}
+
+std::string formatValue(const Field& f, const unsigned char* image) {
+    const unsigned char* p = image + f.offset;
+    const std::string& t = f.type;
+    char text[64];
+    if (f.encoded) {
+        std::snprintf(text, sizeof(text), "%.6g", numeric(p, t) * f.scale + f.bias);
+    } else if (t == "STRING") {
+        std::string s = "'";
+        for (size_t i = 0; i + 1 < f.size && p[i] && s.size() < 40; i++) s += (p[i] >= 32 && p[i] < 127) ? static_cast<char>(p[i]) : '?';
+        return s + "'";
+    } else if (t == "BOOL") {
+        return p[0] ? "TRUE" : "FALSE";
+    } else if (t == "REAL") {
+        std::snprintf(text, sizeof(text), "%.6g", load<float>(p));
+    } else if (t == "LREAL") {
+        std::snprintf(text, sizeof(text), "%.9g", load<double>(p));
+    } else if (t == "SINT" || t == "INT" || t == "DINT" || t == "LINT") {
+        long long v = f.size == 1 ? load<int8_t>(p) : f.size == 2 ? load<int16_t>(p) :
+                      f.size == 4 ? load<int32_t>(p) : load<int64_t>(p);
+        std::snprintf(text, sizeof(text), "%lld", v);
+    } else if (t == "BYTE" || t == "WORD" || t == "DWORD" || t == "LWORD") {
+        unsigned long long v = f.size == 1 ? load<uint8_t>(p) : f.size == 2 ? load<uint16_t>(p) :
+                               f.size == 4 ? load<uint32_t>(p) : load<uint64_t>(p);
+        std::snprintf(text, sizeof(text), "16#%0*llX", static_cast<int>(f.size * 2), v);
+    } else if (t == "TIME") {
+        std::snprintf(text, sizeof(text), "T#%ums", load<uint32_t>(p));
+    } else if (t == "LTIME") {
+        std::snprintf(text, sizeof(text), "LTIME#%lluns", static_cast<unsigned long long>(load<uint64_t>(p)));
+    } else {
+        // Unsigned integers, dates and times of day: raw value
+        unsigned long long v = f.size == 1 ? load<uint8_t>(p) : f.size == 2 ? load<uint16_t>(p) :
+                               f.size == 4 ? load<uint32_t>(p) : load<uint64_t>(p);
+        std::snprintf(text, sizeof(text), "%llu", v);
+    }
+    return text;
+}
+
+std::string formatAge(Clock::duration age) {
+    char text[32];
+    double ms = std::chrono::duration<double, std::milli>(age).count();
+    if (ms < 1000.0) std::snprintf(text, sizeof(text), "%.0f ms", ms);
+    else if (ms < 120000.0) std::snprintf(text, sizeof(text), "%.1f s", ms / 1000.0);
+    else std::snprintf(text, sizeof(text), "%.0f min", ms / 60000.0);
+    return text;
+}
+
+// ---- Terminal -------------------------------------------------------------
+
+#ifdef _WIN32
+class Terminal {
+public:
+    Terminal() {
+        HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        if (GetConsoleMode(out, &mode)) SetConsoleMode(out, mode | 0x0004);    // ENABLE_VIRTUAL_TERMINAL_PROCESSING
+    }
+
+    // Wait up to timeoutMs for a key, -1 if none
+    int Key(int timeoutMs) {
+        auto end = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        do {
+            if (_kbhit()) return _getch();
+            Sleep(10);
+        } while (Clock::now() < end);
+        return -1;
+    }
+
+    int Rows() const {
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+            return info.srWindow.Bottom - info.srWindow.Top + 1;
+        }
+        return 24;
+    }
+};
+#else
+struct termios savedTermios;
+bool termiosSaved = false;
+
+void restoreTerminal() {
+    if (termiosSaved) tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+    termiosSaved = false;
+    std::fputs("\x1b[?25h", stdout);
+    std::fflush(stdout);
+}
+
+void onSignal(int) {
+    restoreTerminal();
+    std::_Exit(0);
+}
+
+class Terminal {
+public:
+    Terminal() : input(isatty(STDIN_FILENO) != 0) {
+        if (input && tcgetattr(STDIN_FILENO, &savedTermios) == 0) {
+            struct termios raw = savedTermios;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            termiosSaved = true;
+        }
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        std::fputs("\x1b[?25l", stdout);    // Hide the cursor
+    }
+
+    ~Terminal() { restoreTerminal(); }
+
+    // Wait up to timeoutMs for a key, -1 if none; the wait is the refresh timer
+    int Key(int timeoutMs) {
+        if (!input) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return -1;
+        }
+        struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&fd, 1, timeoutMs) <= 0) return -1;
+        unsigned char c;
+        if (read(STDIN_FILENO, &c, 1) == 1) return c;
+        input = false;      // End of input, keep refreshing without keys
+        return -1;
+    }
+
+    int Rows() const {
+        struct winsize ws;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) return ws.ws_row;
+        return 24;
+    }
+
+private:
+    bool input;
+};
+#endif
+
+// ---- View ------------------------------------------------------------------
+
+class View {
+public:
+    View(const std::vector<Field>& fields, const std::string& filter)
+        : fields(fields), filter(filter), changingOnly(false), page(0), editing(false) {
+        refilter();
+    }
+
+    // @return false to quit
+    bool Key(int key) {
+        if (editing) {
+            if (key == '\r' || key == '\n') {
+                editing = false;
+                filter = edit;
+                refilter();
+            } else if (key == 27) {
+                editing = false;
+            } else if (key == 127 || key == 8) {
+                if (!edit.empty()) edit.pop_back();
+            } else if (key >= 32 && key < 127) {
+                edit += static_cast<char>(key);
+            }
+            return true;
+        }
+        switch (key) {
+        case 'q': case 'Q': return false;
+        case 'n': case ' ': page++; break;
+        case 'p': case 'b': if (page > 0) page--; break;
+        case 'c': changingOnly = !changingOnly; page = 0; break;
+        case '/': editing = true; edit = filter; break;
+        default: break;
+        }
+        return true;
+    }
+
+    /**
+     * Render one frame; only the rows of the current page are formatted
+     * @param rows Table rows available, 0 = all (no paging)
+     */
+    std::string Render(const Sampler& sampler, const std::string& status, Clock::time_point now, int rows, bool ansi) {
+        std::vector<size_t> shown;
+        const std::vector<size_t>* list = &matches;
+        if (changingOnly) {
+            for (size_t i : matches) {
+                if (sampler.Recent(i, now)) shown.push_back(i);
+            }
+            list = &shown;
+        }
+
+        size_t perPage = rows > 0 ? static_cast<size_t>(rows) : list->size();
+        if (perPage == 0) perPage = 1;
+        size_t pages = (list->size() + perPage - 1) / perPage;
+        if (pages == 0) pages = 1;
+        if (page >= pages) page = pages - 1;
+
+        std::string out;
+        out.reserve(256 + perPage * 96);
+        if (ansi) out += "\x1b[H";
+        char line[512];
+        auto put = [&](const char* text) {
+            out += text;
+            if (ansi) out += "\x1b[K";
+            out += "\n";
+        };
+
+        put(status.c_str());
+        const Heartbeat& plc = sampler.PLC();
+        const Heartbeat& cpp = sampler.CPP();
+        std::snprintf(line, sizeof(line), "LifePLC %d  %.1f/s  age %s    LifeCPP %d  %.1f/s  age %s",
+                      plc.value, plc.rate, formatAge(now - plc.changed).c_str(),
+                      cpp.value, cpp.rate, formatAge(now - cpp.changed).c_str());
+        put(line);
+        if (editing) {
+            std::snprintf(line, sizeof(line), "filter: %s_", edit.c_str());
+        } else {
+            std::snprintf(line, sizeof(line), "fields %zu/%zu  filter \"%s\"%s  page %zu/%zu    n/p page  / filter  c changing  q quit",
+                          list->size(), fields.size(), filter.c_str(), changingOnly ? "  [changing]" : "",
+                          page + 1, pages);
+        }
+        put(line);
+        std::snprintf(line, sizeof(line), "%-36s %-4s %-12s %-24s %9s %9s", "NAME", "DIR", "TYPE", "VALUE", "SEEN/S", "AGE");
+        put(line);
+
+        size_t first = page * perPage;
+        size_t last = std::min(list->size(), first + perPage);
+        for (size_t r = first; r < last; r++) {
+            size_t i = (*list)[r];
+            const Field& f = fields[i];
+            std::string age = sampler.Changed(i) ? formatAge(now - sampler.LastChange(i)) : "-";
+            std::snprintf(line, sizeof(line), "%-36.36s %-4s %-12.12s %-24.24s %9.1f %9s",
+                          f.name.c_str(), f.toCPP ? "in" : "out", f.label.c_str(),
+                          formatValue(f, sampler.Image()).c_str(), sampler.Rate(i), age.c_str());
+            put(line);
+        }
+        if (ansi) out += "\x1b[J";
+        return out;
+    }
+
+private:
+    void refilter() {
+        matches.clear();
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (filter.empty() || fields[i].name.find(filter) != std::string::npos) matches.push_back(i);
+        }
+        page = 0;
+    }
+
+    const std::vector<Field>& fields;
+    std::string filter;
+    std::vector<size_t> matches;
+    bool changingOnly;
+    size_t page;
+    bool editing;
+    std::string edit;
+};
+
+void usage() {
+    std::fprintf(stderr,
+        "Usage: shmtop <schema.json> [options]\n"
+        "  --name <memory name>     Segment name (default: OKZiJMksN52vWF53)\n"
+        "  --filter <text>          Show fields whose name contains text\n"
+        "  --hz <rate>              Refresh rate (default 10)\n"
+        "  --rows <n>               Table rows per page (default: terminal height)\n"
+        "  --once                   Sample for one second, print all matching fields, exit\n"
+        "  --layout packed|aligned  As given to the generator\n"
+        "  --optimize-layout        As given to the generator\n"
+        "  --lockstep               As given to the generator\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    Options opt;
+    opt.schema = argv[1];
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool value = i + 1 < argc;
+        if (arg == "--name" && value) {
+            std::string name = argv[++i];
+            opt.name.assign(name.begin(), name.end());
+        } else if (arg == "--filter" && value) {
+            opt.filter = argv[++i];
+        } else if (arg == "--hz" && value) {
+            opt.hz = std::atof(argv[++i]);
+        } else if (arg == "--rows" && value) {
+            opt.rows = std::atoi(argv[++i]);
+        } else if (arg == "--once") {
+            opt.once = true;
+        } else if (arg == "--layout" && value) {
+            opt.layout = argv[++i];
+        } else if (arg == "--optimize-layout") {
+            opt.optimize = true;
+        } else if (arg == "--lockstep") {
+            opt.lockstep = true;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!(opt.hz > 0.0)) opt.hz = 10.0;
+
+    // Same layout as the generated code
+    UnifiedCodeGenerator gen;
+    std::vector<Field> fields;
+    try {
+        gen.loadSchema(opt.schema);
+        if (!opt.layout.empty()) gen.layoutMode = opt.layout;
+        if (opt.lockstep) gen.lockstep = true;
+        if (opt.optimize || gen.layoutOptimization) gen.optimizeLayout();
+        gen.buildModel();
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "shmtop: %s\n", e.what());
+        return 1;
+    }
+    const UnifiedCodeGenerator::Model& m = gen.model();
+    const UnifiedCodeGenerator::SegmentLayout& layout = m.layout;
+
+    fields.reserve(layout.fields.size());
+    for (size_t i = 0; i < layout.fields.size(); i++) {
+        const UnifiedCodeGenerator::FieldSlot& slot = layout.fields[i];
+        const UnifiedCodeGenerator::Variable& v = gen.variables[i];
+        Field f;
+        f.name = slot.name;
+        f.type = slot.type;
+        f.encoded = !v.encoding.empty();
+        f.label = f.encoded ? slot.type + ":" + v.type : slot.type;
+        f.toCPP = slot.direction == "toCPP";
+        f.offset = slot.offset;
+        f.size = slot.size;
+        f.scale = v.encodingScale;
+        f.bias = v.encodingOffset;
+        fields.push_back(f);
+    }
+
+    GenericSharedMemory segment;
+    segment.SetReadOnly(true);
+    segment.SetLayout(layout.fromCPPOffset, layout.lifePLCOffset);
+    segment.SetHeader(m.layoutHash);
+
+    Sampler sampler(fields, layout.totalSize, layout.lifePLCOffset);
+    View view(fields, opt.filter);
+    std::string schemaName(opt.name.begin(), opt.name.end());
+    const int periodMs = std::max(1, static_cast<int>(1000.0 / opt.hz));
+
+    if (opt.once) {
+        auto end = Clock::now() + std::chrono::milliseconds(1100);
+        while (!segment.Connect(opt.name.c_str(), layout.totalSize)) {
+            if (Clock::now() > end) {
+                std::fprintf(stderr, "shmtop: %s\n", segment.GetStatus() == GenericSharedMemory::LAYOUT_MISMATCH ?
+                             "segment layout does not match the schema" : "segment not found");
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        auto sampled = Clock::now();
+        end = sampled + std::chrono::milliseconds(1100);
+        while (sampled < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+            sampled = Clock::now();
+            sampler.Sample(segment.GetPointer(), sampled);
+        }
+        char status[256];
+        std::snprintf(status, sizeof(status), "%s  segment %s  %zu bytes  generation %08X",
+                      gen.memoryName.c_str(), schemaName.c_str(), layout.totalSize, segment.GetHeaderGeneration());
+        std::string frame = view.Render(sampler, status, sampled, 0, false);
+        std::fwrite(frame.data(), 1, frame.size(), stdout);
+        return 0;
+    }
+
+    Terminal terminal;
+    std::fputs("\x1b[2J", stdout);
+    auto lastAttempt = Clock::now() - std::chrono::seconds(1);
+    while (true) {
+        auto now = Clock::now();
+        std::string status;
+        char text[256];
+        if (segment.IsConnected()) {
+            segment.Sync();     // Read-only: follows PLC restarts, no heartbeat
+        }
+        if (!segment.IsConnected() && now - lastAttempt >= std::chrono::seconds(1)) {
+            lastAttempt = now;
+            if (segment.Connect(opt.name.c_str(), layout.totalSize)) sampler.Reset();
+        }
+        if (segment.IsConnected()) {
+            sampler.Sample(segment.GetPointer(), now);
+            std::snprintf(text, sizeof(text), "%s  segment %s  %zu bytes  generation %08X",
+                          gen.memoryName.c_str(), schemaName.c_str(), layout.totalSize, segment.GetHeaderGeneration());
+        } else {
+            std::snprintf(text, sizeof(text), "%s  segment %s  %s", gen.memoryName.c_str(), schemaName.c_str(),
+                          segment.GetStatus() == GenericSharedMemory::LAYOUT_MISMATCH ? "layout does not match the schema" :
+                          segment.GetStatus() == GenericSharedMemory::NOT_READY ? "header not initialized yet" :
+                          "waiting for the segment");
+        }
+        status = text;
+
+        int rows = opt.rows > 0 ? opt.rows : std::max(1, terminal.Rows() - 5);
+        std::string frame = view.Render(sampler, status, now, rows, true);
+        std::fwrite(frame.data(), 1, frame.size(), stdout);
+        std::fflush(stdout);
+
+        // Keys arriving during the wait are handled right away, the frame follows on schedule
+        auto next = now + std::chrono::milliseconds(periodMs);
+        bool quit = false;
+        while (!quit) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count();
+            if (left <= 0) break;
+            int key = terminal.Key(static_cast<int>(left));
+            if (key >= 0) {
+                quit = !view.Key(key);
+                break;
+            }
+        }
+        if (quit) break;
+    }
+    std::fputs("\x1b[2J\x1b[H", stdout);
+    return 0;
+}